@@ -0,0 +1,594 @@
+// github.com/broly/CppFun
+// This is archetype based entity-component storage
+// Entities with the same set of components live together in chunks, each component type has its own column inside chunk
+// So query touches only chunks that have all requested components and walks their columns linearly
+// Component types are numbered by compile-time counter (`type_id`), component sets are described by `htuple`
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define ARCHETYPE_STORAGE_DEMO
+#endif
+
+#include "../Tuples/HorizontalTuple.h"
+#include "../Static Counter/CompileTimeCounter.h"
+
+#ifdef ARCHETYPE_STORAGE_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+// Max count of component types
+constexpr size_t MaxComponents = 256;
+
+// Component type identifier (used as flag index)
+enum class component_id : size_t {};
+
+// Set of component types
+using component_mask = flagset<component_id, MaxComponents>;
+
+// Identifier of component type (dense, so it may be used as array index)
+template<typename T>
+constexpr component_id component_id_of = component_id(type_id<T>);
+
+// Entity handle
+// Generation changes when entity is destroyed, so stale handles are detected
+struct entity
+{
+    uint32_t Index;
+    uint32_t Generation;
+};
+
+namespace detail
+{
+    // Type-erased operations of component column
+    struct component_ops
+    {
+        size_t Size;
+        size_t Align;
+        void (*MoveConstruct)(void* Dst, void* Src); // move constructs Dst from Src and destroys Src
+        void (*Destroy)(void* Ptr);
+    };
+
+    template<typename T>
+    constexpr component_ops component_ops_of
+    {
+        sizeof(T),
+        alignof(T),
+        [](void* Dst, void* Src)
+        {
+            new (Dst) T(std::move(*static_cast<T*>(Src)));
+            static_cast<T*>(Src)->~T();
+        },
+        [](void* Ptr)
+        {
+            static_cast<T*>(Ptr)->~T();
+        },
+    };
+
+    // No type repeats in Ts (each component type has exactly one column)
+    template<typename... Ts>
+    constexpr bool distinct_types = true;
+
+    template<typename T, typename... Ts>
+    constexpr bool distinct_types<T, Ts...> = (!std::is_same_v<T, Ts> && ...) && distinct_types<Ts...>;
+
+    // Hash of component set (archetype lookup on entity creation)
+    struct component_mask_hash
+    {
+        size_t operator()(const component_mask& Mask) const
+        {
+            uint64_t Hash = 0;
+            for (uint64_t Word : Mask.Words)
+            {
+                Hash = (Hash ^ Word) * 0x9e3779b97f4a7c15ull;
+                Hash ^= Hash >> 29;
+            }
+            return size_t(Hash);
+        }
+    };
+
+    // Bytes of one chunk
+    constexpr size_t ChunkBytes = 16 * 1024;
+
+    // Alignment of each column inside chunk (cache line)
+    constexpr size_t ColumnAlign = 64;
+
+    // Marks that archetype has no column for component
+    constexpr uint16_t NoColumn = UINT16_MAX;
+
+    struct chunk_deleter
+    {
+        void operator()(std::byte* Data) const
+        {
+            ::operator delete(Data, std::align_val_t(ColumnAlign));
+        }
+    };
+
+    // Entities with exactly the same set of components
+    // Rows are always packed: only the last chunk may be partially filled
+    struct archetype
+    {
+        archetype(const component_mask& InMask, const std::array<const component_ops*, MaxComponents>& AllOps)
+            : Mask(InMask)
+        {
+            ColumnOf.fill(NoColumn);
+
+            size_t RowBytes = sizeof(entity);
+            Mask.ForEach([&](component_id Id)
+            {
+                ColumnOf[size_t(Id)] = uint16_t(Ops.size());
+                Ops.push_back(AllOps[size_t(Id)]);
+                RowBytes += AllOps[size_t(Id)]->Size;
+            });
+
+            // Reserve space for alignment padding of each column
+            const size_t PaddingBytes = (Ops.size() + 1) * ColumnAlign;
+            ChunkCapacity = ChunkBytes > PaddingBytes + RowBytes ? (ChunkBytes - PaddingBytes) / RowBytes : 1;
+
+            size_t Offset = 0;
+            EntitiesOffset = Offset;
+            Offset += ChunkCapacity * sizeof(entity);
+            for (const component_ops* Op : Ops)
+            {
+                Offset = (Offset + ColumnAlign - 1) / ColumnAlign * ColumnAlign;
+                ColumnOffsets.push_back(Offset);
+                Offset += ChunkCapacity * Op->Size;
+            }
+            ChunkSize = Offset;
+        }
+
+        archetype(const archetype&) = delete;
+
+        ~archetype()
+        {
+            for (size_t Row = 0; Row < Count; ++Row)
+            {
+                for (size_t Column = 0; Column < Ops.size(); ++Column)
+                {
+                    Ops[Column]->Destroy(At(Row, Column));
+                }
+            }
+        }
+
+        std::byte* ChunkData(size_t Chunk) const
+        {
+            return Chunks[Chunk].get();
+        }
+
+        void* At(size_t Row, size_t Column) const
+        {
+            return ChunkData(Row / ChunkCapacity) + ColumnOffsets[Column] + Row % ChunkCapacity * Ops[Column]->Size;
+        }
+
+        entity& EntityAt(size_t Row) const
+        {
+            return reinterpret_cast<entity*>(ChunkData(Row / ChunkCapacity) + EntitiesOffset)[Row % ChunkCapacity];
+        }
+
+        // Returns new row (components are not constructed yet)
+        size_t Allocate(entity E)
+        {
+            if (Count == Chunks.size() * ChunkCapacity)
+            {
+                Chunks.emplace_back(static_cast<std::byte*>(::operator new(ChunkSize, std::align_val_t(ColumnAlign))));
+            }
+            new (&EntityAt(Count)) entity(E);
+            return Count++;
+        }
+
+        // Moves last row into `Row` (components of `Row` must be already destroyed or moved out)
+        // Returns entity that changed its row (if any)
+        bool FillHole(size_t Row, entity& Moved)
+        {
+            const size_t Last = --Count;
+            const bool HasMoved = Row != Last;
+            if (HasMoved)
+            {
+                for (size_t Column = 0; Column < Ops.size(); ++Column)
+                {
+                    Ops[Column]->MoveConstruct(At(Row, Column), At(Last, Column));
+                }
+                Moved = EntityAt(Row) = EntityAt(Last);
+            }
+            if (Count <= (Chunks.size() - 1) * ChunkCapacity && Chunks.size() > 1)
+            {
+                Chunks.pop_back();
+            }
+            return HasMoved;
+        }
+
+        component_mask Mask;
+        std::vector<const component_ops*> Ops;
+        std::array<uint16_t, MaxComponents> ColumnOf;
+        std::vector<size_t> ColumnOffsets;
+        size_t EntitiesOffset = 0;
+        size_t ChunkCapacity = 0;
+        size_t ChunkSize = 0;
+        size_t Count = 0;
+        std::vector<std::unique_ptr<std::byte[], chunk_deleter>> Chunks;
+
+        // Cached transitions to other archetypes (by added/removed component)
+        std::unordered_map<size_t, size_t> AddEdges;
+        std::unordered_map<size_t, size_t> RemoveEdges;
+    };
+}
+
+// Storage of entities grouped by archetypes
+class archetype_storage
+{
+public:
+    // Creates entity with given components
+    template<typename... Ts>
+    entity Create(Ts... Components)
+    {
+        return Create(htuple<Ts...>(std::move(Components)...));
+    }
+
+    // Creates entity with components taken from tuple
+    template<typename... Ts>
+    entity Create(htuple<Ts...> Components)
+    {
+        return CreateImpl(Components, std::make_index_sequence<sizeof...(Ts)>{});
+    }
+
+    bool IsAlive(entity E) const
+    {
+        return E.Index < Records.size() && Records[E.Index].Generation == E.Generation && Records[E.Index].Alive;
+    }
+
+    bool Destroy(entity E)
+    {
+        if (!IsAlive(E))
+        {
+            return false;
+        }
+
+        record& Record = Records[E.Index];
+        detail::archetype& Arch = *Archetypes[Record.Archetype];
+        for (size_t Column = 0; Column < Arch.Ops.size(); ++Column)
+        {
+            Arch.Ops[Column]->Destroy(Arch.At(Record.Row, Column));
+        }
+        RemoveRow(Arch, Record.Row);
+
+        Record.Alive = false;
+        ++Record.Generation;
+        FreeList.push_back(E.Index);
+        return true;
+    }
+
+    // Returns component of entity or nullptr
+    template<typename T>
+    T* Get(entity E)
+    {
+        if (!IsAlive(E))
+        {
+            return nullptr;
+        }
+
+        const record& Record = Records[E.Index];
+        const detail::archetype& Arch = *Archetypes[Record.Archetype];
+        const uint16_t Column = Arch.ColumnOf[size_t(component_id_of<T>)];
+        return Column != detail::NoColumn ? static_cast<T*>(Arch.At(Record.Row, Column)) : nullptr;
+    }
+
+    // Adds (or replaces) component, moves entity to the archetype with this component
+    template<typename T>
+    bool Add(entity E, T Value)
+    {
+        if (T* Existing = Get<T>(E))
+        {
+            *Existing = std::move(Value);
+            return true;
+        }
+        if (!IsAlive(E))
+        {
+            return false;
+        }
+
+        const size_t Id = size_t(RegisterComponent<T>());
+        const size_t Target = FindEdge(Records[E.Index].Archetype, Id, true);
+        const size_t Row = MoveEntity(E, Target);
+
+        detail::archetype& Arch = *Archetypes[Target];
+        new (Arch.At(Row, Arch.ColumnOf[Id])) T(std::move(Value));
+        return true;
+    }
+
+    // Removes component, moves entity to the archetype without this component
+    template<typename T>
+    bool Remove(entity E)
+    {
+        if (Get<T>(E) == nullptr)
+        {
+            return false;
+        }
+
+        const size_t Id = size_t(component_id_of<T>);
+        MoveEntity(E, FindEdge(Records[E.Index].Archetype, Id, false));
+        return true;
+    }
+
+    // Calls `Func(Ts&...)` for each entity that has all `Ts` components
+    // Walks only matching archetypes, chunk by chunk
+    template<typename... Ts, typename F>
+    void each(F&& Func)
+    {
+        static_assert(detail::distinct_types<Ts...>, "component is listed twice");
+
+        component_mask Required;
+        (Required.Set(component_id_of<Ts>), ...);
+
+        for (const auto& ArchPtr : Archetypes)
+        {
+            detail::archetype& Arch = *ArchPtr;
+            if ((Arch.Mask & Required) != Required)
+            {
+                continue;
+            }
+
+            const std::array<size_t, sizeof...(Ts)> ColumnIndices { Arch.ColumnOf[size_t(component_id_of<Ts>)]... };
+            for (size_t Chunk = 0; Chunk < Arch.Chunks.size(); ++Chunk)
+            {
+                const size_t Count = std::min(Arch.ChunkCapacity, Arch.Count - Chunk * Arch.ChunkCapacity);
+                EachInChunk<Ts...>(Arch, Chunk, Count, ColumnIndices, Func, std::make_index_sequence<sizeof...(Ts)>{});
+            }
+        }
+    }
+
+    // Count of alive entities
+    size_t size() const
+    {
+        return Records.size() - FreeList.size();
+    }
+
+    size_t archetype_count() const
+    {
+        return Archetypes.size();
+    }
+
+private:
+    struct record
+    {
+        uint32_t Archetype;
+        uint32_t Row;
+        uint32_t Generation;
+        bool Alive;
+    };
+
+    template<typename T>
+    component_id RegisterComponent()
+    {
+        static_assert(size_t(component_id_of<T>) < MaxComponents, "too many component types");
+        static_assert(alignof(T) <= detail::ColumnAlign, "component is overaligned");
+
+        ComponentOps[size_t(component_id_of<T>)] = &detail::component_ops_of<T>;
+        return component_id_of<T>;
+    }
+
+    template<typename... Ts, size_t... Indices>
+    entity CreateImpl(htuple<Ts...>& Components, std::index_sequence<Indices...>)
+    {
+        static_assert(detail::distinct_types<Ts...>, "entity can't have the same component twice");
+
+        component_mask Mask;
+        (Mask.Set(RegisterComponent<Ts>()), ...);
+
+        const entity E = NewEntity();
+        const size_t ArchIndex = FindArchetype(Mask);
+        detail::archetype& Arch = *Archetypes[ArchIndex];
+        const size_t Row = Arch.Allocate(E);
+        (new (Arch.At(Row, Arch.ColumnOf[size_t(component_id_of<Ts>)])) Ts(std::move(Components.template GetRef<Indices>())), ...);
+
+        Records[E.Index].Archetype = uint32_t(ArchIndex);
+        Records[E.Index].Row = uint32_t(Row);
+        return E;
+    }
+
+    template<typename... Ts, typename F, size_t... Indices>
+    static void EachInChunk(detail::archetype& Arch, size_t Chunk, size_t Count, const std::array<size_t, sizeof...(Ts)>& ColumnIndices, F& Func, std::index_sequence<Indices...>)
+    {
+        std::byte* Data = Arch.ChunkData(Chunk);
+        htuple<Ts*...> Columns { reinterpret_cast<Ts*>(Data + Arch.ColumnOffsets[ColumnIndices[Indices]])... };
+        for (size_t Row = 0; Row < Count; ++Row)
+        {
+            Func(Columns.template Get<Indices>()[Row]...);
+        }
+    }
+
+    entity NewEntity()
+    {
+        if (!FreeList.empty())
+        {
+            const uint32_t Index = FreeList.back();
+            FreeList.pop_back();
+            Records[Index].Alive = true;
+            return entity { Index, Records[Index].Generation };
+        }
+        Records.push_back(record { 0, 0, 0, true });
+        return entity { uint32_t(Records.size() - 1), 0 };
+    }
+
+    size_t FindArchetype(const component_mask& Mask)
+    {
+        const auto [It, bInserted] = ArchetypeIndices.try_emplace(Mask, Archetypes.size());
+        if (bInserted)
+        {
+            Archetypes.push_back(std::make_unique<detail::archetype>(Mask, ComponentOps));
+        }
+        return It->second;
+    }
+
+    size_t FindEdge(size_t From, size_t Id, bool IsAdd)
+    {
+        auto& Edges = IsAdd ? Archetypes[From]->AddEdges : Archetypes[From]->RemoveEdges;
+        if (auto It = Edges.find(Id); It != Edges.end())
+        {
+            return It->second;
+        }
+
+        component_mask Mask = Archetypes[From]->Mask;
+        IsAdd ? Mask.Set(component_id(Id)) : Mask.Reset(component_id(Id));
+        const size_t To = FindArchetype(Mask);
+        Edges[Id] = To;
+        return To;
+    }
+
+    // Moves entity row to another archetype, shared components are moved, others are destroyed
+    // Returns new row (components that are absent in source are not constructed)
+    size_t MoveEntity(entity E, size_t Target)
+    {
+        record& Record = Records[E.Index];
+        detail::archetype& From = *Archetypes[Record.Archetype];
+        detail::archetype& To = *Archetypes[Target];
+
+        const size_t Row = To.Allocate(E);
+        From.Mask.ForEach([&](component_id Id)
+        {
+            const uint16_t Column = From.ColumnOf[size_t(Id)];
+            if (To.ColumnOf[size_t(Id)] != detail::NoColumn)
+            {
+                From.Ops[Column]->MoveConstruct(To.At(Row, To.ColumnOf[size_t(Id)]), From.At(Record.Row, Column));
+            } else
+            {
+                From.Ops[Column]->Destroy(From.At(Record.Row, Column));
+            }
+        });
+        RemoveRow(From, Record.Row);
+
+        Record.Archetype = uint32_t(Target);
+        Record.Row = uint32_t(Row);
+        return Row;
+    }
+
+    void RemoveRow(detail::archetype& Arch, size_t Row)
+    {
+        entity Moved;
+        if (Arch.FillHole(Row, Moved))
+        {
+            Records[Moved.Index].Row = uint32_t(Row);
+        }
+    }
+
+    std::vector<std::unique_ptr<detail::archetype>> Archetypes;
+    std::unordered_map<component_mask, size_t, detail::component_mask_hash> ArchetypeIndices;
+    std::vector<record> Records;
+    std::vector<uint32_t> FreeList;
+    std::array<const detail::component_ops*, MaxComponents> ComponentOps {};
+};
+
+#ifdef ARCHETYPE_STORAGE_DEMO
+    #undef ARCHETYPE_STORAGE_DEMO
+
+struct Position { float X, Y; };
+struct Velocity { float X, Y; };
+struct Health { int Value; };
+struct Name { char Text[48]; };
+
+// Update of 1M entities: archetype columns vs vector of htuple (whole entity per element)
+void Benchmark()
+{
+    constexpr size_t EntityCount = 1000000;
+    constexpr int Frames = 20;
+
+    using clock = std::chrono::steady_clock;
+    auto Milliseconds = [](clock::time_point Start) { return std::chrono::duration<double, std::milli>(clock::now() - Start).count(); };
+
+    clock::time_point Start = clock::now();
+    archetype_storage Storage;
+    for (size_t i = 0; i < EntityCount; ++i)
+    {
+        Storage.Create(Position { 0, 0 }, Velocity { 1, float(i % 4) }, Health { 100 }, Name {});
+    }
+    std::cout << "Create (archetype): " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = clock::now();
+    std::vector<htuple<Position, Velocity, Health, Name>> Entities;
+    for (size_t i = 0; i < EntityCount; ++i)
+    {
+        Entities.push_back(htuple { Position { 0, 0 }, Velocity { 1, float(i % 4) }, Health { 100 }, Name {} });
+    }
+    std::cout << "Create (vector of htuple): " << Milliseconds(Start) << " ms" << std::endl;
+
+    // Only Position and Velocity columns are read, Health and Name stay out of cache
+    Start = clock::now();
+    for (int Frame = 0; Frame < Frames; ++Frame)
+    {
+        Storage.each<Position, Velocity>([](Position& P, const Velocity& V)
+        {
+            P.X += V.X;
+            P.Y += V.Y;
+        });
+    }
+    std::cout << "Update (archetype): " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = clock::now();
+    for (int Frame = 0; Frame < Frames; ++Frame)
+    {
+        for (auto& Entity : Entities)
+        {
+            Position& P = Entity.GetRef<0>();
+            const Velocity& V = Entity.GetRef<1>();
+            P.X += V.X;
+            P.Y += V.Y;
+        }
+    }
+    std::cout << "Update (vector of htuple): " << Milliseconds(Start) << " ms" << std::endl;
+
+    float Check = 0;
+    Storage.each<Position>([&](const Position& P) { Check += P.Y; });
+    for (auto& Entity : Entities)
+    {
+        Check -= Entity.GetRef<0>().Y;
+    }
+    std::cout << "Difference: " << Check << std::endl; // 0
+}
+
+int main()
+{
+    archetype_storage Storage;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Storage.Create(Position { 0, 0 }, Velocity { 1, float(i) });
+    }
+    entity Tree = Storage.Create(htuple { Position { 5, 5 }, Health { 100 } });
+    entity Rock = Storage.Create(Position { 7, 7 });
+
+    // Only archetypes with Position and Velocity are visited
+    Storage.each<Position, Velocity>([](Position& P, const Velocity& V)
+    {
+        P.X += V.X;
+        P.Y += V.Y;
+    });
+
+    float SumY = 0;
+    Storage.each<Position>([&](const Position& P) { SumY += P.Y; });
+    std::cout << "Sum Y: " << SumY << std::endl; // 18
+
+    Storage.Add(Rock, Velocity { 0, -1 });
+    Storage.Remove<Health>(Tree);
+    std::cout << "Tree health: " << (Storage.Get<Health>(Tree) != nullptr) << std::endl; // 0
+    std::cout << "Rock velocity: " << Storage.Get<Velocity>(Rock)->Y << std::endl; // -1
+
+    Storage.Destroy(Tree);
+    std::cout << "Entities: " << Storage.size() << std::endl; // 5
+    std::cout << "Archetypes: " << Storage.archetype_count() << std::endl; // 3
+
+    Benchmark();
+}
+#endif
@@ -0,0 +1,264 @@
+// github.com/broly/CppFun
+// This is monotonic arena memory resource
+// Allocation is a pointer bump inside the current block, deallocation does nothing
+// Reset frees the whole batch at once (O(1)) and keeps blocks for the next batch, so steady workload doesn't touch malloc at all
+// It is std::pmr::memory_resource, so pmr containers, strings and tuples (constructed with std::allocator_arg) can use it
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define MONOTONIC_ARENA_DEMO
+#endif
+
+#include "../Tuples/HorizontalTuple.h"
+#include "../Tuples/VerticalTuple.h"
+#include "../Tuples/MiniTuple.h"
+
+#ifdef MONOTONIC_ARENA_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+class monotonic_arena : public std::pmr::memory_resource
+{
+public:
+    // InitialBlockSize - size of the first block, each next block is twice bigger
+    // InUpstream       - resource that gives blocks
+    explicit monotonic_arena(size_t InitialBlockSize = 64 * 1024, std::pmr::memory_resource* InUpstream = std::pmr::get_default_resource())
+        : NextBlockSize(std::max<size_t>(InitialBlockSize, 256))
+        , Upstream(InUpstream)
+    {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+
+    ~monotonic_arena()
+    {
+        Release();
+    }
+
+    // Frees everything allocated since the last reset, blocks stay for reuse
+    // Destructors are not called, so objects must be trivially destructible or already destroyed
+    void Reset()
+    {
+        Current = Head;
+        Cursor = Head ? Head->Data() : nullptr;
+        End = Head ? Head->Data() + Head->Size : nullptr;
+    }
+
+    // Returns all blocks to upstream resource
+    void Release()
+    {
+        while (Head)
+        {
+            block* Next = Head->Next;
+            Upstream->deallocate(Head, sizeof(block) + Head->Size, alignof(block));
+            Head = Next;
+        }
+        Current = nullptr;
+        Cursor = End = nullptr;
+    }
+
+    // Count of blocks taken from upstream
+    size_t BlockCount() const
+    {
+        size_t Count = 0;
+        for (block* Block = Head; Block; Block = Block->Next)
+        {
+            ++Count;
+        }
+        return Count;
+    }
+
+private:
+    // Block header, data goes right after it
+    struct alignas(std::max_align_t) block
+    {
+        block* Next;
+        size_t Size;
+
+        std::byte* Data()
+        {
+            return reinterpret_cast<std::byte*>(this + 1);
+        }
+    };
+
+    void* do_allocate(size_t Bytes, size_t Alignment) override
+    {
+        if (std::byte* Ptr = TryBump(Bytes, Alignment))
+        {
+            return Ptr;
+        }
+
+        // Reuse next kept block if it's big enough, otherwise insert new one after current
+        block* Next = Current ? Current->Next : Head;
+        if (!Next || Next->Size < Bytes + Alignment)
+        {
+            Next = NewBlock(Bytes + Alignment);
+        }
+
+        Current = Next;
+        Cursor = Next->Data();
+        End = Next->Data() + Next->Size;
+        return TryBump(Bytes, Alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {
+        // Memory is freed with the whole batch by Reset
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override
+    {
+        return this == &Other;
+    }
+
+    std::byte* TryBump(size_t Bytes, size_t Alignment)
+    {
+        if (!Cursor)
+        {
+            return nullptr;
+        }
+
+        const uintptr_t Aligned = (reinterpret_cast<uintptr_t>(Cursor) + Alignment - 1) & ~uintptr_t(Alignment - 1);
+        if (Aligned + Bytes > reinterpret_cast<uintptr_t>(End))
+        {
+            return nullptr;
+        }
+
+        std::byte* Ptr = Cursor + (Aligned - reinterpret_cast<uintptr_t>(Cursor));
+        Cursor = Ptr + Bytes;
+        return Ptr;
+    }
+
+    block* NewBlock(size_t MinSize)
+    {
+        const size_t Size = std::max(NextBlockSize, MinSize);
+        NextBlockSize *= 2;
+
+        block* Block = static_cast<block*>(Upstream->allocate(sizeof(block) + Size, alignof(block)));
+        Block->Size = Size;
+
+        // Keep allocation order: new block goes right after current one
+        if (Current)
+        {
+            Block->Next = Current->Next;
+            Current->Next = Block;
+        } else
+        {
+            Block->Next = Head;
+            Head = Block;
+        }
+        return Block;
+    }
+
+    block* Head = nullptr;
+    block* Current = nullptr;
+    std::byte* Cursor = nullptr;
+    std::byte* End = nullptr;
+    size_t NextBlockSize;
+    std::pmr::memory_resource* Upstream;
+};
+
+#ifdef MONOTONIC_ARENA_DEMO
+    #undef MONOTONIC_ARENA_DEMO
+
+// Upstream resource that counts allocations
+struct counting_resource : std::pmr::memory_resource
+{
+    size_t Allocations = 0;
+
+    void* do_allocate(size_t Bytes, size_t Alignment) override
+    {
+        ++Allocations;
+        return std::pmr::new_delete_resource()->allocate(Bytes, Alignment);
+    }
+
+    void do_deallocate(void* Ptr, size_t Bytes, size_t Alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(Ptr, Bytes, Alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override
+    {
+        return this == &Other;
+    }
+};
+
+using request = htuple<std::pmr::string, std::pmr::vector<int>, int>;
+
+// One request-sized batch of tuples, every string and vector is constructed in place with the batch allocator
+void BuildBatch(std::pmr::memory_resource* Resource)
+{
+    std::pmr::vector<request> Requests(Resource);
+    Requests.reserve(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        Requests.emplace_back("request header that doesn't fit small string", size_t(8), i);
+    }
+}
+
+// Time of BatchCount batches: straight from global new/delete vs arena reset after each batch
+void Benchmark()
+{
+    constexpr int BatchCount = 2000;
+
+    using clock = std::chrono::steady_clock;
+    auto Milliseconds = [](clock::time_point Start) { return std::chrono::duration<double, std::milli>(clock::now() - Start).count(); };
+
+    clock::time_point Start = clock::now();
+    for (int Batch = 0; Batch < BatchCount; ++Batch)
+    {
+        BuildBatch(std::pmr::new_delete_resource());
+    }
+    std::cout << "Batches (new_delete_resource): " << Milliseconds(Start) << " ms" << std::endl;
+
+    monotonic_arena Arena(64 * 1024, std::pmr::new_delete_resource());
+    Start = clock::now();
+    for (int Batch = 0; Batch < BatchCount; ++Batch)
+    {
+        BuildBatch(&Arena);
+        Arena.Reset();
+    }
+    std::cout << "Batches (monotonic_arena): " << Milliseconds(Start) << " ms" << std::endl;
+}
+
+int main()
+{
+    // Anything that slips past the given resource lands here
+    counting_resource Default;
+    std::pmr::set_default_resource(&Default);
+
+    counting_resource Direct;
+    BuildBatch(&Direct);
+    std::cout << "Direct allocations: " << Direct.Allocations << ", default resource: " << Default.Allocations << std::endl; // 2001, 0
+
+    counting_resource Upstream;
+    monotonic_arena Arena(64 * 1024, &Upstream);
+    for (int Batch = 0; Batch < 10; ++Batch)
+    {
+        BuildBatch(&Arena);
+        Arena.Reset();
+    }
+    std::cout << "Arena allocations (10 batches): " << Upstream.Allocations << ", default resource: " << Default.Allocations << std::endl; // 2, 0
+
+    // Tuples outside containers
+    minituple<std::pmr::string, int> Mini { std::allocator_arg, std::pmr::polymorphic_allocator<>(&Arena), "long enough to allocate on heap", 1 };
+    vtuple<std::pmr::string, int> Vert { std::allocator_arg, std::pmr::polymorphic_allocator<>(&Arena), "long enough to allocate on heap", 2 };
+    std::cout << "Uses arena: " << (Mini.GetRef<0>().get_allocator().resource() == &Arena) << (Vert.GetRef<0>().get_allocator().resource() == &Arena) << std::endl; // 11
+    std::cout << "Default resource after all: " << Default.Allocations << std::endl; // 0
+
+    std::pmr::set_default_resource(nullptr);
+
+    Benchmark();
+}
+#endif
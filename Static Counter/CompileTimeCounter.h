@@ -3,7 +3,22 @@
 // Works since C++20
 // github.com/broly/CppFun
 
+#pragma once
+
 #include <iostream>
+#include <array>
+#include <utility>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <initializer_list>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
 
 namespace detail
 {
@@ -46,12 +61,28 @@ namespace detail
             // just instantiate for cache (and use it with comma operator to avoid optimization out)
             return helper(), false;
         }
+
+        // same as `exists`, but never produces `helper`, so checking doesn't take current `Index`
+        template<typename T = this_inst, bool = is_instantiated(T{})>
+        static consteval bool peek(check_t check)
+        { 
+            return true; 
+        }
+
+        static consteval bool peek(...)
+        {
+            return false;
+        }
     };
 }
 
 // Counter class. 
 // Each instance gives possibility to generate unique integer sequence from 0
 // CounterUniqueId - unique identifier that gives possibility to generate unique counter_index_cacher(s)
+// `next` and `count` recurse once per already generated index, so a counter with N indices needs
+//   template and constexpr recursion depth above N. Defaults are enough for ~500 indices
+//   (Clang: -ftemplate-depth=1024, -fconstexpr-depth=512), bigger counters (e.g. 1024 flags) need
+//   -ftemplate-depth=N+64 -fconstexpr-depth=N+64 (MSVC: /constexpr:depthN+64)
 template<auto CounterUniqueId = []{}>
 struct Counter
 {
@@ -71,11 +102,22 @@ struct Counter
             return Index;
         }
     }
-};
 
-// Unqiue counters
-using cnt = Counter<>;
-using cnt2 = Counter<>;
+    // Count of already generated indices (doesn't increment the counter)
+    // Index  - CountingIndex
+    // PeekId - Unique `count` member function tag (lambda is always unique)
+    template<size_t Index = 0, auto PeekId = []{}>
+    static consteval size_t count() 
+    {
+        if constexpr (detail::counter_index_cacher<Index, CounterUniqueId>::peek(detail::check)) 
+        {
+            return count<Index + 1>();
+        } else 
+        {
+            return Index;
+        }
+    }
+};
 
 // Special counter for enum masks
 template<auto CounterUniqueId = []{}>
@@ -85,10 +127,595 @@ struct Masker : private Counter<CounterUniqueId>
     template<auto = []{}>
     static consteval size_t next() 
     {
-        return 1 << Counter<CounterUniqueId>::next();
+        constexpr size_t Index = Counter<CounterUniqueId>::next();
+        static_assert(Index < sizeof(size_t) * 8, "mask doesn't fit, use `next_index` with `flagset`");
+        return size_t(1) << Index;
+    }
+
+    // Wide mode: gives flag index instead of mask (no width limit, use it with `flagset`)
+    template<auto = []{}>
+    static consteval size_t next_index() 
+    {
+        return Counter<CounterUniqueId>::next();
+    }
+
+    // Count of generated flags (size for `flagset`)
+    template<auto Tag = []{}>
+    static consteval size_t count() 
+    {
+        return Counter<CounterUniqueId>::template count<0, Tag>();
+    }
+};
+
+namespace detail
+{
+    enum class flag_op { union_op, intersection_op };
+
+    // Applies operation to words of flagset (uses AVX2/SSE2 when available)
+    template<flag_op Op>
+    constexpr void flag_words_apply(uint64_t* Dst, const uint64_t* Src, size_t Count)
+    {
+        size_t i = 0;
+        if (!std::is_constant_evaluated())
+        {
+#if defined(__AVX2__)
+            for (; i + 4 <= Count; i += 4)
+            {
+                const __m256i A = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Dst + i));
+                const __m256i B = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + i));
+                const __m256i R = Op == flag_op::union_op ? _mm256_or_si256(A, B) : _mm256_and_si256(A, B);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i), R);
+            }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 2 <= Count; i += 2)
+            {
+                const __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Dst + i));
+                const __m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + i));
+                const __m128i R = Op == flag_op::union_op ? _mm_or_si128(A, B) : _mm_and_si128(A, B);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + i), R);
+            }
+#endif
+        }
+        // tail (or whole set in constant evaluation)
+        for (; i < Count; ++i)
+        {
+            Dst[i] = Op == flag_op::union_op ? Dst[i] | Src[i] : Dst[i] & Src[i];
+        }
+    }
+}
+
+// Flag set of any width
+// Enum - enum with flag indices (generated by `Masker::next_index`)
+// Size - count of flags (usually `Masker::count()` after enum declaration)
+template<typename Enum, size_t Size>
+struct flagset
+{
+    static_assert(Size > 0, "empty flagset");
+
+    static constexpr size_t word_bits = 64;
+    static constexpr size_t word_count = (Size + word_bits - 1) / word_bits;
+    static constexpr size_t size = Size;
+
+    constexpr flagset() = default;
+
+    constexpr flagset(std::initializer_list<Enum> Flags)
+    {
+        for (Enum Flag : Flags)
+        {
+            Set(Flag);
+        }
+    }
+
+    constexpr void Set(Enum Flag)
+    {
+        Words[Word(Flag)] |= Bit(Flag);
+    }
+
+    constexpr void Reset(Enum Flag)
+    {
+        Words[Word(Flag)] &= ~Bit(Flag);
+    }
+
+    constexpr bool Test(Enum Flag) const
+    {
+        return (Words[Word(Flag)] & Bit(Flag)) != 0;
+    }
+
+    // Count of set flags
+    constexpr size_t Count() const
+    {
+        size_t Result = 0;
+        for (uint64_t W : Words)
+        {
+            Result += std::popcount(W);
+        }
+        return Result;
+    }
+
+    constexpr bool Any() const
+    {
+        for (uint64_t W : Words)
+        {
+            if (W != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls `Func(Enum)` for each set flag in ascending order
+    template<typename F>
+    constexpr void ForEach(F&& Func) const
+    {
+        for (size_t i = 0; i < word_count; ++i)
+        {
+            for (uint64_t W = Words[i]; W != 0; W &= W - 1)
+            {
+                Func(static_cast<Enum>(i * word_bits + std::countr_zero(W)));
+            }
+        }
+    }
+
+    // Union
+    constexpr flagset& operator|=(const flagset& Other)
+    {
+        detail::flag_words_apply<detail::flag_op::union_op>(Words, Other.Words, word_count);
+        return *this;
+    }
+
+    // Intersection
+    constexpr flagset& operator&=(const flagset& Other)
+    {
+        detail::flag_words_apply<detail::flag_op::intersection_op>(Words, Other.Words, word_count);
+        return *this;
+    }
+
+    friend constexpr flagset operator|(flagset A, const flagset& B)
+    {
+        return A |= B;
+    }
+
+    friend constexpr flagset operator&(flagset A, const flagset& B)
+    {
+        return A &= B;
+    }
+
+    friend constexpr bool operator==(const flagset&, const flagset&) = default;
+
+    // AVX2 alignment only pays off once a set spans a whole 256-bit register, small sets stay word-sized
+    alignas(word_count >= 4 ? 32 : alignof(uint64_t)) uint64_t Words[word_count] {};
+
+private:
+    static constexpr size_t Word(Enum Flag)
+    {
+        return static_cast<size_t>(Flag) / word_bits;
+    }
+
+    static constexpr uint64_t Bit(Enum Flag)
+    {
+        return uint64_t(1) << (static_cast<size_t>(Flag) % word_bits);
+    }
+};
+
+// Layout of precomputed tables
+enum class table_layout
+{
+    plain,          // tightly packed values
+    simd_aligned,   // 32 byte aligned and padded to whole AVX2 chunks
+};
+
+// Compile-time lookup table: Func(0), Func(1), ..., Func(N - 1)
+// It is constant initialized (lives in .rodata), so hot path does a load instead of computing
+template<auto Func, size_t N, table_layout Layout = table_layout::plain>
+struct counter_table
+{
+    using value_type = decltype(Func(size_t{}));
+
+    static constexpr size_t size = N;
+    static constexpr size_t chunk = Layout == table_layout::simd_aligned && sizeof(value_type) < 32 ? 32 / sizeof(value_type) : 1;
+    static constexpr size_t padded_size = (N + chunk - 1) / chunk * chunk;
+    static constexpr size_t alignment = Layout == table_layout::simd_aligned ? 32 : alignof(value_type);
+
+    // padding (if any) is value-initialized
+    alignas(alignment) static constexpr std::array<value_type, padded_size> values = []
+    {
+        std::array<value_type, padded_size> Result {};
+        for (size_t i = 0; i < N; ++i)
+        {
+            Result[i] = Func(i);
+        }
+        return Result;
+    }();
+
+    static constexpr value_type get(size_t Index)
+    {
+        return values[Index];
+    }
+};
+
+// Compile-time lookup table with interleaved entries: row i is {Funcs(i)...}
+// All values of one index share the cache line
+template<size_t N, auto... Funcs>
+struct interleaved_counter_table
+{
+    using value_type = std::common_type_t<decltype(Funcs(size_t{}))...>;
+    using row_type = std::array<value_type, sizeof...(Funcs)>;
+
+    static constexpr size_t size = N;
+
+    static constexpr std::array<row_type, N> values = []
+    {
+        std::array<row_type, N> Result {};
+        for (size_t i = 0; i < N; ++i)
+        {
+            Result[i] = row_type { static_cast<value_type>(Funcs(i))... };
+        }
+        return Result;
+    }();
+
+    static constexpr const row_type& get(size_t Index)
+    {
+        return values[Index];
+    }
+};
+
+// Special counter for integral functions
+template<auto Func = [](int) -> int {}, auto CounterUniqueId = []{}>
+struct CounterFunc : private Counter<CounterUniqueId>
+{
+    // We should make `next` unique always, so we use lambda as template parameter
+    template<auto = []{}>
+    static consteval size_t next() 
+    {
+        return Func(Counter<CounterUniqueId>::next());
+    }
+
+    // Precomputed Func(0), Func(1), ..., Func(N - 1) (doesn't touch the counter)
+    template<size_t N, table_layout Layout = table_layout::plain>
+    using table = counter_table<Func, N, Layout>;
+};
+
+// Special counter for dense type identifiers
+// Each type takes its own index (0, 1, 2, ...) on first `id<T>` usage
+template<auto CounterUniqueId = []{}>
+struct TypeCounter : private Counter<CounterUniqueId>
+{
+    // Variable template is instantiated only once per type, so type takes exactly one index
+    template<typename T>
+    static constexpr size_t id = Counter<CounterUniqueId>::next();
+
+    // Count of types registered so far
+    template<auto Tag = []{}>
+    static consteval size_t count() 
+    {
+        return Counter<CounterUniqueId>::template count<0, Tag>();
+    }
+};
+
+// Default type identifiers registry
+using tcnt = TypeCounter<>;
+
+template<typename T>
+constexpr size_t type_id = tcnt::id<T>;
+
+// Tag is forwarded, so the call depends on it and each `type_count()` use counts again
+template<auto Tag = []{}>
+consteval size_t type_count()
+{
+    return tcnt::template count<Tag>();
+}
+
+// Plain array dispatch table indexed by type identifier (no hashing, O(1) lookup)
+// Fn    - handler function type (e.g. void(const void*))
+// Size  - count of handled types (usually `type_count()` after all types are registered)
+// Types - type identifiers registry
+template<typename Fn, size_t Size, typename Types = tcnt>
+struct dispatch_table
+{
+    template<typename T>
+    constexpr void Register(Fn* Handler)
+    {
+        static_assert(Types::template id<T> < Size, "type was registered after table size was taken");
+        Handlers[Types::template id<T>] = Handler;
+    }
+
+    template<typename T>
+    constexpr Fn* Get() const
+    {
+        return Handlers[Types::template id<T>];
+    }
+
+    constexpr Fn* operator[](size_t Id) const
+    {
+        return Handlers[Id];
+    }
+
+    template<typename... Args>
+    decltype(auto) Invoke(size_t Id, Args&&... InArgs) const
+    {
+        return Handlers[Id](std::forward<Args>(InArgs)...);
+    }
+
+    std::array<Fn*, Size> Handlers {};
+};
+
+namespace detail
+{
+    // Unique counter identifier for enum registrations
+    template<typename Enum>
+    struct enum_tag {};
+
+    // FNV-1a
+    constexpr uint64_t enum_name_hash(std::string_view Name)
+    {
+        uint64_t Hash = 0xcbf29ce484222325ull;
+        for (char Ch : Name)
+        {
+            Hash = (Hash ^ static_cast<uint8_t>(Ch)) * 0x100000001b3ull;
+        }
+        return Hash;
+    }
+
+    // Rehashes name hash with bucket seed
+    constexpr uint64_t enum_hash_mix(uint64_t Hash, uint64_t Seed)
+    {
+        Hash ^= Seed * 0x9e3779b97f4a7c15ull;
+        Hash ^= Hash >> 33;
+        Hash *= 0xff51afd7ed558ccdull;
+        Hash ^= Hash >> 33;
+        return Hash;
+    }
+
+    // Enum value as unsigned integer
+    template<typename Enum>
+    constexpr uint64_t enum_raw(Enum Value)
+    {
+        return static_cast<uint64_t>(static_cast<std::underlying_type_t<Enum>>(Value));
+    }
+
+    // Minimal perfect hash (hash and displace): 
+    //   name goes to bucket `Hash % N`, bucket seed moves it to its own slot `mix(Hash, Seed) % N`
+    template<size_t N>
+    struct enum_perfect_hash
+    {
+        std::array<uint32_t, N> Seeds {};  // seed of each bucket
+        std::array<uint32_t, N> Slots {};  // entry index of each slot
+
+        // Returns index of the only entry that may have this name
+        constexpr size_t Find(std::string_view Name) const
+        {
+            const uint64_t Hash = enum_name_hash(Name);
+            return Slots[enum_hash_mix(Hash, Seeds[Hash % N]) % N];
+        }
+    };
+
+    template<size_t N>
+    constexpr enum_perfect_hash<N> make_enum_perfect_hash(const std::array<std::string_view, N>& Names)
+    {
+        enum_perfect_hash<N> Result;
+
+        std::array<uint64_t, N> Hashes {};
+        std::array<size_t, N + 1> BucketStart {};
+        for (size_t i = 0; i < N; ++i)
+        {
+            Hashes[i] = enum_name_hash(Names[i]);
+            ++BucketStart[Hashes[i] % N + 1];
+        }
+
+        // Group entries by bucket
+        size_t MaxBucketSize = 0;
+        for (size_t b = 0; b < N; ++b)
+        {
+            MaxBucketSize = std::max(MaxBucketSize, BucketStart[b + 1]);
+            BucketStart[b + 1] += BucketStart[b];
+        }
+        std::array<size_t, N> Members {};
+        std::array<size_t, N> Fill {};
+        for (size_t i = 0; i < N; ++i)
+        {
+            const size_t Bucket = Hashes[i] % N;
+            Members[BucketStart[Bucket] + Fill[Bucket]++] = i;
+        }
+
+        // Place the largest buckets first, while there are a lot of free slots
+        std::array<bool, N> Taken {};
+        std::array<size_t, N> Trial {};
+        for (size_t Size = MaxBucketSize; Size > 0; --Size)
+        {
+            for (size_t b = 0; b < N; ++b)
+            {
+                if (BucketStart[b + 1] - BucketStart[b] != Size)
+                {
+                    continue;
+                }
+
+                for (uint32_t Seed = 0;; ++Seed)
+                {
+                    if (Seed == UINT32_MAX)
+                    {
+                        throw "perfect hash seed not found";
+                    }
+
+                    bool Fits = true;
+                    for (size_t k = 0; k < Size && Fits; ++k)
+                    {
+                        Trial[k] = enum_hash_mix(Hashes[Members[BucketStart[b] + k]], Seed) % N;
+                        Fits = !Taken[Trial[k]];
+                        for (size_t j = 0; j < k && Fits; ++j)
+                        {
+                            Fits = Trial[j] != Trial[k];
+                        }
+                    }
+
+                    if (Fits)
+                    {
+                        Result.Seeds[b] = Seed;
+                        for (size_t k = 0; k < Size; ++k)
+                        {
+                            Taken[Trial[k]] = true;
+                            Result.Slots[Trial[k]] = static_cast<uint32_t>(Members[BucketStart[b] + k]);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        return Result;
+    }
+}
+
+// Registered enumerator (specialized by REFLECT_ENUM)
+// Index - registration index of enumerator
+template<typename Enum, size_t Index>
+struct enum_entry;
+
+// Registers enumerator name and value, each enum has its own counter
+// Registration goes through `Counter::next`, so enum with N registered names needs recursion depth above N (see `Counter`),
+//   e.g. 4096 names: -ftemplate-depth=4200 -fconstexpr-depth=4200, and Clang also needs -fconstexpr-steps=100000000
+//   for the perfect hash of that size (GCC default -fconstexpr-ops-limit is enough)
+#define REFLECT_ENUM(Enum, Name) \
+    template<> \
+    struct enum_entry<Enum, Counter<detail::enum_tag<Enum>{}>::next()> \
+    { \
+        static constexpr std::string_view name = #Name; \
+        static constexpr Enum value = Enum::Name; \
+    };
+
+// Count of registered enumerators
+template<typename Enum, auto Tag = []{}>
+consteval size_t enum_count()
+{
+    return Counter<detail::enum_tag<Enum>{}>::template count<0, Tag>();
+}
+
+// Enum <-> string conversion over registered enumerators
+// Count - count of registered enumerators (`enum_count<Enum>()` after all registrations)
+template<typename Enum, size_t Count>
+struct enum_reflection
+{
+    static_assert(Count > 0, "enum has no registered enumerators");
+
+    static constexpr std::array<std::string_view, Count> names = []<size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        return std::array<std::string_view, Count> { enum_entry<Enum, Indices>::name... };
+    }(std::make_index_sequence<Count>{});
+
+    static constexpr std::array<Enum, Count> values = []<size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        return std::array<Enum, Count> { enum_entry<Enum, Indices>::value... };
+    }(std::make_index_sequence<Count>{});
+
+    // String to enum
+    static constexpr std::optional<Enum> from_string(std::string_view Name)
+    {
+        const size_t Index = hash.Find(Name);
+        if (names[Index] == Name)
+        {
+            return values[Index];
+        }
+        return std::nullopt;
     }
+
+    // Enum to string (empty for unregistered values)
+    static constexpr std::string_view to_string(Enum Value)
+    {
+        const uint64_t Raw = detail::enum_raw(Value);
+        std::string_view Result;
+        if constexpr (layout == value_layout::dense)
+        {
+            if (Raw - min_value < by_value_size)
+            {
+                Result = by_value[Raw - min_value];
+            }
+        } else if constexpr (layout == value_layout::mask)
+        {
+            if (std::has_single_bit(Raw) && Raw <= max_value)
+            {
+                Result = by_value[std::countr_zero(Raw)];
+            }
+        } else
+        {
+            const auto It = std::lower_bound(sorted_values.begin(), sorted_values.end(), Raw);
+            if (It != sorted_values.end() && *It == Raw)
+            {
+                Result = by_value[It - sorted_values.begin()];
+            }
+        }
+        return Result;
+    }
+
+private:
+    static constexpr detail::enum_perfect_hash<Count> hash = detail::make_enum_perfect_hash(names);
+
+    // How values are mapped to dense array of names
+    enum class value_layout
+    {
+        dense,  // value - min (values are close to each other)
+        mask,   // bit index (Masker values)
+        sorted, // binary search over sorted values (any other values)
+    };
+
+    static constexpr uint64_t min_value = detail::enum_raw(*std::min_element(values.begin(), values.end(), [](Enum A, Enum B) { return detail::enum_raw(A) < detail::enum_raw(B); }));
+    static constexpr uint64_t max_value = detail::enum_raw(*std::max_element(values.begin(), values.end(), [](Enum A, Enum B) { return detail::enum_raw(A) < detail::enum_raw(B); }));
+
+    static constexpr value_layout layout = 
+        max_value - min_value < Count * 2 ? value_layout::dense :
+        std::all_of(values.begin(), values.end(), [](Enum V) { return std::has_single_bit(detail::enum_raw(V)); }) ? value_layout::mask :
+        value_layout::sorted;
+
+    static constexpr size_t by_value_size = 
+        layout == value_layout::dense ? max_value - min_value + 1 :
+        layout == value_layout::mask ? std::bit_width(max_value) :
+        Count;
+
+    static constexpr std::array<uint64_t, Count> sorted_values = []
+    {
+        std::array<uint64_t, Count> Result {};
+        for (size_t i = 0; i < Count; ++i)
+        {
+            Result[i] = detail::enum_raw(values[i]);
+        }
+        std::sort(Result.begin(), Result.end());
+        return Result;
+    }();
+
+    static constexpr std::array<std::string_view, by_value_size> by_value = []
+    {
+        std::array<std::string_view, by_value_size> Result {};
+        for (size_t i = 0; i < Count; ++i)
+        {
+            const uint64_t Raw = detail::enum_raw(values[i]);
+            if constexpr (layout == value_layout::dense)
+            {
+                Result[Raw - min_value] = names[i];
+            } else if constexpr (layout == value_layout::mask)
+            {
+                Result[std::countr_zero(Raw)] = names[i];
+            } else
+            {
+                Result[std::lower_bound(sorted_values.begin(), sorted_values.end(), Raw) - sorted_values.begin()] = names[i];
+            }
+        }
+        return Result;
+    }();
 };
 
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
+
+#include <bitset>
+#include <chrono>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+// Unqiue counters
+using cnt = Counter<>;
+using cnt2 = Counter<>;
+
 enum class Enum1
 {
     a = cnt::next(),
@@ -116,21 +743,20 @@ enum class MaskEnum
     d = msk::next(),
 };
 
+// Yet another special unique counter (for wide flags)
+using flg = Masker<>;
 
-// Special counter for integral functions
-template<auto Func = [](int) -> int {}, auto CounterUniqueId = []{}>
-struct CounterFunc : private Counter<CounterUniqueId>
+enum class FlagEnum
 {
-    // We should make `next` unique always, so we use lambda as template parameter
-    template<auto = []{}>
-    static consteval size_t next() 
-    {
-        return Func(Counter<CounterUniqueId>::next());
-    }
+    a = flg::next_index(),
+    b = flg::next_index(),
+    c = flg::next_index(),
+    d = flg::next_index(),
 };
 
-using sqcnt = CounterFunc<[] (size_t a) -> size_t { return a * a; }>;
+using FlagEnumSet = flagset<FlagEnum, flg::count()>;
 
+using sqcnt = CounterFunc<[] (size_t a) -> size_t { return a * a; }>;
 
 enum class SqrEnum
 {
@@ -141,6 +767,437 @@ enum class SqrEnum
     e = sqcnt::next(),
 };
 
+// Whole squares table at once
+using sqtable = sqcnt::table<16, table_layout::simd_aligned>;
+
+// Tables are built at compile time, no dynamic initialization
+static_assert(sqtable::values[5] == 25);
+
+// CRC32 table
+using crc32_table = counter_table<[] (size_t Index) -> uint32_t 
+{
+    uint32_t Crc = static_cast<uint32_t>(Index);
+    for (int Bit = 0; Bit < 8; ++Bit)
+    {
+        Crc = (Crc & 1) ? (0xEDB88320u ^ (Crc >> 1)) : (Crc >> 1);
+    }
+    return Crc;
+}, 256>;
+
+static_assert(crc32_table::values[1] == 0x77073096u);
+
+// Squares and cubes side by side
+using powtable = interleaved_counter_table<8, 
+    [] (size_t a) { return a * a; }, 
+    [] (size_t a) { return a * a * a; }>;
+
+struct MsgA {};
+struct MsgB {};
+struct MsgC {};
+
+// Register types in fixed order
+constexpr size_t MsgAId = type_id<MsgA>;
+constexpr size_t MsgBId = type_id<MsgB>;
+constexpr size_t MsgCId = type_id<MsgC>;
+
+constexpr size_t MsgCount = type_count();
+
+// Generated message types for dispatch benchmark
+template<size_t Index>
+struct Msg {};
+
+// Each benchmark size numbers its messages in its own registry
+// 1000 types need deeper recursion (see `Counter`), so that size is built only with CPPFUN_DEMO_LARGE
+using msg_types_10 = TypeCounter<[]{}>;
+using msg_types_100 = TypeCounter<[]{}>;
+#ifdef CPPFUN_DEMO_LARGE
+using msg_types_1000 = TypeCounter<[]{}>;
+#endif
+
+REFLECT_ENUM(Enum1, a)
+REFLECT_ENUM(Enum1, b)
+REFLECT_ENUM(Enum1, c)
+REFLECT_ENUM(Enum1, d)
+
+REFLECT_ENUM(MaskEnum, a)
+REFLECT_ENUM(MaskEnum, b)
+REFLECT_ENUM(MaskEnum, c)
+REFLECT_ENUM(MaskEnum, d)
+
+REFLECT_ENUM(SqrEnum, a)
+REFLECT_ENUM(SqrEnum, b)
+REFLECT_ENUM(SqrEnum, c)
+REFLECT_ENUM(SqrEnum, d)
+REFLECT_ENUM(SqrEnum, e)
+
+using Enum1Names = enum_reflection<Enum1, enum_count<Enum1>()>;
+using MaskEnumNames = enum_reflection<MaskEnum, enum_count<MaskEnum>()>;
+using SqrEnumNames = enum_reflection<SqrEnum, enum_count<SqrEnum>()>;
+
+enum class Opcode { load, store, add, sub, mul, div, jump, branch, call, ret, push, pop, move, compare, nop, halt };
+
+REFLECT_ENUM(Opcode, load)
+REFLECT_ENUM(Opcode, store)
+REFLECT_ENUM(Opcode, add)
+REFLECT_ENUM(Opcode, sub)
+REFLECT_ENUM(Opcode, mul)
+REFLECT_ENUM(Opcode, div)
+REFLECT_ENUM(Opcode, jump)
+REFLECT_ENUM(Opcode, branch)
+REFLECT_ENUM(Opcode, call)
+REFLECT_ENUM(Opcode, ret)
+REFLECT_ENUM(Opcode, push)
+REFLECT_ENUM(Opcode, pop)
+REFLECT_ENUM(Opcode, move)
+REFLECT_ENUM(Opcode, compare)
+REFLECT_ENUM(Opcode, nop)
+REFLECT_ENUM(Opcode, halt)
+
+using OpcodeNames = enum_reflection<Opcode, enum_count<Opcode>()>;
+
+// N generated names ("e0", "e1", ...), each one is zero-terminated in its own 8 chars
+template<size_t N>
+constexpr std::array<std::array<char, 8>, N> GenerateNames()
+{
+    std::array<std::array<char, 8>, N> Storage {};
+    for (size_t i = 0; i < N; ++i)
+    {
+        size_t Length = 0;
+        Storage[i][Length++] = 'e';
+        for (size_t Digits = i, Div = 1000; Div > 0; Div /= 10)
+        {
+            if (i >= Div || Div == 1)
+            {
+                Storage[i][Length++] = char('0' + Digits / Div % 10);
+            }
+        }
+    }
+    return Storage;
+}
+
+template<size_t N>
+constexpr std::array<std::string_view, N> NameViews(const std::array<std::array<char, 8>, N>& Storage)
+{
+    std::array<std::string_view, N> Names {};
+    for (size_t i = 0; i < N; ++i)
+    {
+        Names[i] = std::string_view(Storage[i].data());
+    }
+    return Names;
+}
+
+// Perfect hash of N generated names finds each name at its own index
+template<size_t N>
+constexpr bool CheckPerfectHash()
+{
+    const std::array<std::array<char, 8>, N> Storage = GenerateNames<N>();
+    const std::array<std::string_view, N> Names = NameViews(Storage);
+
+    const detail::enum_perfect_hash<N> Hash = detail::make_enum_perfect_hash(Names);
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (Hash.Find(Names[i]) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(CheckPerfectHash<16>());
+static_assert(CheckPerfectHash<256>());
+
+using demo_clock = std::chrono::steady_clock;
+
+double Milliseconds(demo_clock::time_point Start)
+{
+    return std::chrono::duration<double, std::milli>(demo_clock::now() - Start).count();
+}
+
+// Pseudo-random sequence for benchmarks
+uint64_t NextRandom(uint64_t& Seed)
+{
+    Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+    return Seed >> 33;
+}
+
+// Flags given by index directly (`Masker::next_index` produces the same values)
+enum class WideFlag : size_t {};
+
+// Union, intersection, count and iteration of flag set with Size flags
+template<size_t Size>
+consteval bool CheckFlagset()
+{
+    using set = flagset<WideFlag, Size>;
+
+    set Even, Odd, All;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        (i % 2 ? Odd : Even).Set(WideFlag(i));
+        All.Set(WideFlag(i));
+    }
+
+    size_t Visited = 0;
+    size_t Sum = 0;
+    All.ForEach([&](WideFlag Flag) { ++Visited; Sum += size_t(Flag); });
+
+    set Last = All;
+    Last.Reset(WideFlag(0));
+
+    return (Even | Odd) == All && !(Even & Odd).Any() && (All & Even) == Even
+        && All.Count() == Size && Even.Count() == Size / 2
+        && All.Test(WideFlag(Size - 1)) && !Last.Test(WideFlag(0))
+        && Visited == Size && Sum == Size * (Size - 1) / 2;
+}
+
+static_assert(CheckFlagset<8>());
+static_assert(CheckFlagset<64>());
+static_assert(CheckFlagset<256>());
+static_assert(CheckFlagset<1024>());
+
+static_assert(sizeof(flagset<WideFlag, 8>) == 8 && alignof(flagset<WideFlag, 256>) == 32);
+
+// Flag index taken from counter, variable template takes exactly one index per Index
+template<typename Flags, size_t Index>
+constexpr size_t counted_flag = Flags::template next_index<Index>();
+
+// Takes one flag index per Indices, returns count of distinct indices (out of range index fails compilation)
+template<typename Flags, size_t... Indices>
+consteval size_t RegisterFlags(std::index_sequence<Indices...>)
+{
+    flagset<WideFlag, sizeof...(Indices)> Set;
+    (Set.Set(WideFlag(counted_flag<Flags, Indices>)), ...);
+    return Set.Count();
+}
+
+// Counter-driven flag sets: flags are numbered by `Masker::next_index`, set is sized from `Masker::count()`
+using flg64 = Masker<>;
+using flg256 = Masker<>;
+
+static_assert(RegisterFlags<flg64>(std::make_index_sequence<64>{}) == 64);
+static_assert(RegisterFlags<flg256>(std::make_index_sequence<256>{}) == 256);
+
+using CountedFlags64 = flagset<WideFlag, flg64::count()>;
+using CountedFlags256 = flagset<WideFlag, flg256::count()>;
+
+static_assert(CountedFlags64::size == 64 && CheckFlagset<CountedFlags64::size>());
+static_assert(CountedFlags256::size == 256 && CheckFlagset<CountedFlags256::size>());
+
+// (A & B) | C and count over random sets: flagset vs std::bitset
+template<size_t Size>
+void BenchmarkFlagset()
+{
+    constexpr size_t SetCount = 4096;
+    constexpr size_t Rounds = 1000;
+
+    std::vector<flagset<WideFlag, Size>> Flags(SetCount);
+    std::vector<std::bitset<Size>> Bits(SetCount);
+    uint64_t Seed = 1;
+    for (size_t i = 0; i < SetCount; ++i)
+    {
+        for (size_t k = 0; k < Size / 4; ++k)
+        {
+            const size_t Index = NextRandom(Seed) % Size;
+            Flags[i].Set(WideFlag(Index));
+            Bits[i].set(Index);
+        }
+    }
+
+    size_t FlagsTotal = 0;
+    demo_clock::time_point Start = demo_clock::now();
+    for (size_t Round = 0; Round < Rounds; ++Round)
+    {
+        for (size_t i = 0; i < SetCount; ++i)
+        {
+            FlagsTotal += ((Flags[i] & Flags[(i + Round) % SetCount]) | Flags[(i + 7) % SetCount]).Count();
+        }
+    }
+    std::cout << "Set operations (flagset<" << Size << ">): " << Milliseconds(Start) << " ms" << std::endl;
+
+    size_t BitsTotal = 0;
+    Start = demo_clock::now();
+    for (size_t Round = 0; Round < Rounds; ++Round)
+    {
+        for (size_t i = 0; i < SetCount; ++i)
+        {
+            BitsTotal += ((Bits[i] & Bits[(i + Round) % SetCount]) | Bits[(i + 7) % SetCount]).count();
+        }
+    }
+    std::cout << "Set operations (std::bitset<" << Size << ">): " << Milliseconds(Start) << " ms" << std::endl;
+    std::cout << "Same result: " << (FlagsTotal == BitsTotal) << std::endl; // 1
+}
+
+// CRC32 of 64 MB: precomputed `crc32_table` vs computing each table entry at runtime (bit by bit)
+void BenchmarkTable()
+{
+    std::vector<uint8_t> Data(64 * 1024 * 1024);
+    uint64_t Seed = 1;
+    for (uint8_t& Byte : Data)
+    {
+        Byte = uint8_t(NextRandom(Seed));
+    }
+
+    demo_clock::time_point Start = demo_clock::now();
+    uint32_t TableCrc = ~0u;
+    for (uint8_t Byte : Data)
+    {
+        TableCrc = crc32_table::get((TableCrc ^ Byte) & 0xFF) ^ (TableCrc >> 8);
+    }
+    std::cout << "CRC32 (counter_table): " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = demo_clock::now();
+    uint32_t RuntimeCrc = ~0u;
+    for (uint8_t Byte : Data)
+    {
+        RuntimeCrc ^= Byte;
+        for (int Bit = 0; Bit < 8; ++Bit)
+        {
+            RuntimeCrc = (RuntimeCrc & 1) ? (0xEDB88320u ^ (RuntimeCrc >> 1)) : (RuntimeCrc >> 1);
+        }
+    }
+    std::cout << "CRC32 (runtime): " << Milliseconds(Start) << " ms" << std::endl;
+    std::cout << "Same result: " << (TableCrc == RuntimeCrc) << std::endl; // 1
+}
+
+// Name to enum: perfect hash vs unordered_map<std::string, Opcode> (one of 9 names is unknown)
+void BenchmarkEnumParse()
+{
+    std::unordered_map<std::string, Opcode> Map;
+    for (size_t i = 0; i < OpcodeNames::names.size(); ++i)
+    {
+        Map.emplace(OpcodeNames::names[i], OpcodeNames::values[i]);
+    }
+
+    constexpr size_t LookupCount = 10000000;
+    std::vector<std::string> Inputs(LookupCount);
+    uint64_t Seed = 1;
+    for (std::string& Input : Inputs)
+    {
+        const size_t Index = NextRandom(Seed) % (OpcodeNames::names.size() + 2);
+        Input = Index < OpcodeNames::names.size() ? std::string(OpcodeNames::names[Index]) : std::string("unknown");
+    }
+
+    demo_clock::time_point Start = demo_clock::now();
+    size_t HashSum = 0;
+    for (const std::string& Input : Inputs)
+    {
+        const std::optional<Opcode> Value = OpcodeNames::from_string(Input);
+        HashSum += Value ? size_t(*Value) + 1 : 0;
+    }
+    std::cout << "Parse (enum_reflection): " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = demo_clock::now();
+    size_t MapSum = 0;
+    for (const std::string& Input : Inputs)
+    {
+        const auto It = Map.find(Input);
+        MapSum += It != Map.end() ? size_t(It->second) + 1 : 0;
+    }
+    std::cout << "Parse (unordered_map<string>): " << Milliseconds(Start) << " ms" << std::endl;
+    std::cout << "Same result: " << (HashSum == MapSum) << std::endl; // 1
+}
+
+// Name to index over N generated names: perfect hash and name compare vs unordered_map<std::string, size_t> (one of 9 names is unknown)
+// The hash is built at runtime, 4096 names exceed default constexpr limits (see `REFLECT_ENUM`)
+template<size_t N>
+void BenchmarkNameLookup()
+{
+    const std::array<std::array<char, 8>, N> Storage = GenerateNames<N>();
+    const std::array<std::string_view, N> Names = NameViews(Storage);
+    const detail::enum_perfect_hash<N> Hash = detail::make_enum_perfect_hash(Names);
+
+    std::unordered_map<std::string, size_t> Map;
+    for (size_t i = 0; i < N; ++i)
+    {
+        Map.emplace(Names[i], i);
+    }
+
+    constexpr size_t LookupCount = 10000000;
+    std::vector<std::string> Inputs(LookupCount);
+    uint64_t Seed = 1;
+    for (std::string& Input : Inputs)
+    {
+        const size_t Index = NextRandom(Seed) % (N + N / 8);
+        Input = Index < N ? std::string(Names[Index]) : std::string("unknown");
+    }
+
+    demo_clock::time_point Start = demo_clock::now();
+    size_t HashSum = 0;
+    for (const std::string& Input : Inputs)
+    {
+        const size_t Index = Hash.Find(Input);
+        HashSum += Names[Index] == Input ? Index + 1 : 0;
+    }
+    std::cout << "Name lookup over " << N << " names (perfect hash): " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = demo_clock::now();
+    size_t MapSum = 0;
+    for (const std::string& Input : Inputs)
+    {
+        const auto It = Map.find(Input);
+        MapSum += It != Map.end() ? It->second + 1 : 0;
+    }
+    std::cout << "Name lookup over " << N << " names (unordered_map<string>): " << Milliseconds(Start) << " ms" << std::endl;
+    std::cout << "Same result: " << (HashSum == MapSum) << std::endl; // 1
+}
+
+// Sum of handled message indices (checks that both dispatchers called the same handlers)
+uint64_t HandledSum = 0;
+
+template<size_t Index>
+void HandleMsg(const void*)
+{
+    HandledSum += Index + 1;
+}
+
+// Dispatch over Size message types by dense type identifier vs hashed std::type_index
+template<size_t Size, typename Registry>
+void BenchmarkDispatch()
+{
+    using handler = void(const void*);
+
+    dispatch_table<handler, Size, Registry> Table;
+    std::unordered_map<std::type_index, handler*> Map;
+    std::array<size_t, Size> Ids;
+    std::vector<std::type_index> Types;
+    [&]<size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        (Table.template Register<Msg<Indices>>(&HandleMsg<Indices>), ...);
+        (Map.emplace(typeid(Msg<Indices>), &HandleMsg<Indices>), ...);
+        Ids = { Registry::template id<Msg<Indices>>... };
+        Types = { typeid(Msg<Indices>)... };
+    }(std::make_index_sequence<Size>{});
+
+    constexpr size_t MessageCount = 10000000;
+    std::vector<size_t> MessageIds(MessageCount);
+    std::vector<std::type_index> MessageTypes(MessageCount, typeid(Msg<0>));
+    uint64_t Seed = 1;
+    for (size_t i = 0; i < MessageCount; ++i)
+    {
+        const size_t Kind = NextRandom(Seed) % Size;
+        MessageIds[i] = Ids[Kind];
+        MessageTypes[i] = Types[Kind];
+    }
+
+    HandledSum = 0;
+    demo_clock::time_point Start = demo_clock::now();
+    for (size_t Id : MessageIds)
+    {
+        Table.Invoke(Id, nullptr);
+    }
+    std::cout << "Dispatch over " << Size << " types (type_id table): " << Milliseconds(Start) << " ms" << std::endl;
+    const uint64_t TableSum = HandledSum;
+
+    HandledSum = 0;
+    Start = demo_clock::now();
+    for (const std::type_index& Type : MessageTypes)
+    {
+        Map.find(Type)->second(nullptr);
+    }
+    std::cout << "Dispatch over " << Size << " types (unordered_map<type_index>): " << Milliseconds(Start) << " ms" << std::endl;
+    std::cout << "Same result: " << (TableSum == HandledSum) << std::endl; // 1
+}
+
 int main()
 {
     std::cout << (int)Enum1::a;  // 0
@@ -164,9 +1221,72 @@ int main()
     
     std::cout << "\n";
 
+    FlagEnumSet Flags1 {FlagEnum::a, FlagEnum::c};
+    FlagEnumSet Flags2 {FlagEnum::c, FlagEnum::d};
+    (Flags1 | Flags2).ForEach([](FlagEnum F) { std::cout << (int)F; }); // 023
+    std::cout << (Flags1 & Flags2).Count(); // 1
+    std::cout << (Flags1 & Flags2).Test(FlagEnum::c); // 1
+    
+    std::cout << "\n";
+
     std::cout << (int)SqrEnum::a; // 0
     std::cout << (int)SqrEnum::b; // 1
     std::cout << (int)SqrEnum::c; // 4
     std::cout << (int)SqrEnum::d; // 9
     std::cout << (int)SqrEnum::e; // 16
+    std::cout << sqtable::get(7); // 49
+    std::cout << powtable::get(3)[1]; // 27
+
+    std::cout << "\n";
+
+    uint32_t Crc = ~0u;
+    for (const char* Ch = "qwerty"; *Ch; ++Ch)
+    {
+        Crc = crc32_table::get((Crc ^ static_cast<uint8_t>(*Ch)) & 0xFF) ^ (Crc >> 8);
+    }
+    std::cout << std::hex << ~Crc << std::dec; // 3498d7d
+
+    std::cout << "\n";
+
+    std::cout << MsgAId; // 0
+    std::cout << MsgBId; // 1
+    std::cout << MsgCId; // 2
+    std::cout << MsgCount; // 3
+
+    std::cout << "\n";
+
+    dispatch_table<void(const void*), MsgCount> Table;
+    Table.Register<MsgA>([](const void*) { std::cout << "A"; });
+    Table.Register<MsgB>([](const void*) { std::cout << "B"; });
+    Table.Register<MsgC>([](const void*) { std::cout << "C"; });
+
+    MsgB Msg;
+    Table.Invoke(type_id<MsgB>, &Msg); // B
+
+    std::cout << "\n";
+
+    std::cout << Enum1Names::to_string(Enum1::c);       // c
+    std::cout << MaskEnumNames::to_string(MaskEnum::d); // d
+    std::cout << SqrEnumNames::to_string(SqrEnum::e);   // e
+    std::cout << (int)*MaskEnumNames::from_string("c"); // 4
+    std::cout << (int)*SqrEnumNames::from_string("d");  // 9
+    std::cout << SqrEnumNames::from_string("x").has_value(); // 0
+    std::cout << CheckPerfectHash<4096>(); // 1 (at runtime: it exceeds default constexpr limits, see `REFLECT_ENUM`)
+
+    std::cout << "\n";
+
+    BenchmarkDispatch<10, msg_types_10>();
+    BenchmarkDispatch<100, msg_types_100>();
+#ifdef CPPFUN_DEMO_LARGE
+    BenchmarkDispatch<1000, msg_types_1000>();
+#endif
+    BenchmarkTable();
+    BenchmarkEnumParse();
+    BenchmarkNameLookup<16>();
+    BenchmarkNameLookup<256>();
+    BenchmarkNameLookup<4096>();
+    BenchmarkFlagset<64>();
+    BenchmarkFlagset<256>();
+    BenchmarkFlagset<1024>();
 }
+#endif
@@ -0,0 +1,219 @@
+// This is runtime companion of compile-time counter
+// `sharded_counter` - statistics counter split into cache-line padded shards, each thread increments its own shard
+//                     so increments from many cores don't bounce one cache line
+// `id_allocator`    - unique runtime identifiers, each thread takes a whole block of ids at once
+//                     so most allocations are plain thread-local increments without any atomic operation
+// Works since C++20
+// github.com/broly/CppFun
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace detail
+{
+    // Sequential index of current thread (used to pick the shard)
+    inline size_t this_thread_shard_index()
+    {
+        static std::atomic<size_t> NextIndex = 0;
+        static thread_local const size_t Index = NextIndex.fetch_add(1, std::memory_order_relaxed);
+        return Index;
+    }
+}
+
+// Sharded counter
+// Shards - count of shards (threads with the same index modulo Shards share the shard)
+template<size_t Shards = 64>
+class sharded_counter
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Staleness - how old value `ReadApproximate` may return
+    explicit sharded_counter(clock::duration InStaleness = std::chrono::milliseconds(10))
+        : Staleness(InStaleness)
+    {}
+
+    sharded_counter(const sharded_counter&) = delete;
+
+    void Add(uint64_t Value = 1)
+    {
+        ShardValues[detail::this_thread_shard_index() % Shards].Value.fetch_add(Value, std::memory_order_relaxed);
+    }
+
+    // Exact sum: includes every increment that happened before this call
+    // Touches all shards, so it's meant for rare reads
+    uint64_t Read() const
+    {
+        uint64_t Sum = 0;
+        for (const shard& Shard : ShardValues)
+        {
+            Sum += Shard.Value.load(std::memory_order_acquire);
+        }
+        return Sum;
+    }
+
+    // Cached sum that is at most `Staleness` old
+    // Usually it is one load of the shared cache line, shards are summed only when cache is expired
+    uint64_t ReadApproximate() const
+    {
+        const int64_t Now = clock::now().time_since_epoch().count();
+        if (Now - CachedAt.load(std::memory_order_relaxed) < Staleness.count())
+        {
+            return CachedValue.load(std::memory_order_relaxed);
+        }
+
+        const uint64_t Value = Read();
+        CachedValue.store(Value, std::memory_order_relaxed);
+        CachedAt.store(Now, std::memory_order_relaxed);
+        return Value;
+    }
+
+private:
+    // Each shard has its own cache line
+    struct alignas(64) shard
+    {
+        std::atomic<uint64_t> Value = 0;
+    };
+
+    shard ShardValues[Shards];
+
+    clock::duration Staleness;
+    alignas(64) mutable std::atomic<uint64_t> CachedValue = 0;
+    mutable std::atomic<int64_t> CachedAt = INT64_MIN / 2;
+};
+
+// Unique identifier allocator
+// Ids are unique but not dense: a block taken by a thread may be left partially used
+// AllocatorUniqueId - unique identifier of allocator (each instance has its own sequence, like `Counter`)
+// BlockSize         - count of ids taken by thread at once
+template<auto AllocatorUniqueId = []{}, uint64_t BlockSize = 1024>
+struct id_allocator
+{
+    static uint64_t next()
+    {
+        if (Block.Current == Block.End)
+        {
+            Block.Current = NextBlock.fetch_add(BlockSize, std::memory_order_relaxed);
+            Block.End = Block.Current + BlockSize;
+        }
+        return Block.Current++;
+    }
+
+private:
+    struct block
+    {
+        uint64_t Current = 0;
+        uint64_t End = 0;
+    };
+
+    alignas(64) static inline std::atomic<uint64_t> NextBlock = 0;
+    static inline thread_local block Block;
+};
+
+// Unique allocators
+using session_ids = id_allocator<>;
+using request_ids = id_allocator<>;
+
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
+
+// Sum of benchmark results (keeps results alive)
+std::atomic<uint64_t> BenchmarkSink = 0;
+
+// Runs `Func()` Iterations times on each thread, returns milliseconds
+// Results of `Func` are summed per thread and published once, so the loop itself shares nothing but what `Func` touches
+template<typename F>
+double TimeThreads(size_t ThreadCount, size_t Iterations, F Func)
+{
+    const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    std::vector<std::thread> Threads;
+    for (size_t t = 0; t < ThreadCount; ++t)
+    {
+        Threads.emplace_back([&]
+        {
+            uint64_t Local = 0;
+            for (size_t i = 0; i < Iterations; ++i)
+            {
+                if constexpr (std::is_void_v<std::invoke_result_t<F&>>)
+                {
+                    Func();
+                } else
+                {
+                    Local += Func();
+                }
+            }
+            BenchmarkSink.fetch_add(Local, std::memory_order_relaxed);
+        });
+    }
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+}
+
+// Increments and id allocations from all cores: sharded vs one shared atomic
+void Benchmark()
+{
+    const size_t ThreadCount = std::max(2u, std::thread::hardware_concurrency());
+    constexpr size_t Iterations = 10000000;
+
+    sharded_counter Sharded;
+    std::cout << "Add (sharded_counter): " << TimeThreads(ThreadCount, Iterations, [&] { Sharded.Add(); }) << " ms" << std::endl;
+
+    alignas(64) std::atomic<uint64_t> Shared = 0;
+    std::cout << "Add (shared atomic): " << TimeThreads(ThreadCount, Iterations, [&] { Shared.fetch_add(1, std::memory_order_relaxed); }) << " ms" << std::endl;
+    std::cout << "Same count: " << (Sharded.Read() == Shared.load()) << std::endl; // 1
+
+    using benchmark_ids = id_allocator<>;
+    std::cout << "Ids (id_allocator): " << TimeThreads(ThreadCount, Iterations, [] { return benchmark_ids::next(); }) << " ms" << std::endl;
+
+    alignas(64) std::atomic<uint64_t> NextId = 0;
+    std::cout << "Ids (shared atomic): " << TimeThreads(ThreadCount, Iterations, [&] { return NextId.fetch_add(1, std::memory_order_relaxed); }) << " ms" << std::endl;
+}
+
+int main()
+{
+    sharded_counter Requests;
+
+    std::vector<std::thread> Threads;
+    std::vector<std::vector<uint64_t>> Ids(4);
+    for (size_t t = 0; t < 4; ++t)
+    {
+        Threads.emplace_back([&, t]
+        {
+            for (int i = 0; i < 100000; ++i)
+            {
+                Requests.Add();
+                Ids[t].push_back(session_ids::next());
+            }
+        });
+    }
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    std::cout << "Requests: " << Requests.Read() << std::endl; // 400000
+    std::cout << "Requests (approximate): " << Requests.ReadApproximate() << std::endl; // 400000
+
+    std::vector<uint64_t> AllIds;
+    for (const std::vector<uint64_t>& ThreadIds : Ids)
+    {
+        AllIds.insert(AllIds.end(), ThreadIds.begin(), ThreadIds.end());
+    }
+    std::sort(AllIds.begin(), AllIds.end());
+    std::cout << "Unique ids: " << std::unique(AllIds.begin(), AllIds.end()) - AllIds.begin() << std::endl; // 400000
+    std::cout << "Other sequence: " << request_ids::next() << std::endl; // 0
+
+    Benchmark();
+}
+#endif
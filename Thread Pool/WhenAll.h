@@ -0,0 +1,135 @@
+// github.com/broly/CppFun
+// This is fork-join over tuple of heterogeneous tasks
+// `when_all` runs each callable of htuple on the work-stealing pool and returns htuple of their results
+// `parallel_for_each` calls function for each element of htuple in parallel
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define WHEN_ALL_DEMO
+#endif
+
+#include "WorkStealingPool.h"
+#include "../Tuples/HorizontalTuple.h"
+
+#ifdef WHEN_ALL_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+namespace detail
+{
+    // Result of task that returns nothing
+    struct void_result {};
+
+    template<typename F>
+    using task_result_t = std::conditional_t<
+        std::is_void_v<std::invoke_result_t<F&>>,
+        void_result,
+        std::invoke_result_t<F&>>;
+
+    template<typename F>
+    task_result_t<F> invoke_task(F& Func)
+    {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&>>)
+        {
+            Func();
+            return void_result {};
+        } else
+        {
+            return Func();
+        }
+    }
+
+    template<typename... Fs, size_t... Indices>
+    auto when_all_impl(htuple<Fs...>& Tasks, work_stealing_pool& Pool, std::index_sequence<Indices...>)
+    {
+        htuple<std::optional<task_result_t<Fs>>...> Results { std::optional<task_result_t<Fs>>{}... };
+
+        task_group Group(Pool);
+        (Group.Run([&Tasks, &Results]
+        {
+            Results.template GetRef<Indices>().emplace(invoke_task(Tasks.template GetRef<Indices>()));
+        }), ...);
+        Group.Wait();
+
+        return htuple<task_result_t<Fs>...>(std::move(*Results.template GetRef<Indices>())...);
+    }
+}
+
+// Runs all tasks in parallel and waits for them
+// Returns htuple of results (`detail::void_result` for tasks without result)
+// If any task throws, the first exception is rethrown after all tasks are done
+template<typename... Fs>
+auto when_all(htuple<Fs...> Tasks, work_stealing_pool& Pool = work_stealing_pool::Default())
+{
+    return detail::when_all_impl(Tasks, Pool, std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+// Calls `Func(Element)` for each element of tuple in parallel
+template<typename... Ts, typename F>
+void parallel_for_each(htuple<Ts...>& Tuple, F&& Func, work_stealing_pool& Pool = work_stealing_pool::Default())
+{
+    [&]<size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        task_group Group(Pool);
+        (Group.Run([&Tuple, &Func] { Func(Tuple.template GetRef<Indices>()); }), ...);
+        Group.Wait();
+    }(std::make_index_sequence<sizeof...(Ts)>{});
+}
+
+#ifdef WHEN_ALL_DEMO
+    #undef WHEN_ALL_DEMO
+
+// Deliberately unbalanced work
+long long SlowSum(long long Count)
+{
+    long long Sum = 0;
+    for (long long i = 0; i < Count; ++i)
+    {
+        Sum += i % 7;
+    }
+    return Sum;
+}
+
+int main()
+{
+    auto Results = when_all(htuple {
+        [] { return SlowSum(100000000); },
+        [] { return std::string("fast"); },
+        [] { return 2.5 * 2; },
+        [] {},
+    });
+    std::cout << "Results: " << Results.Get<0>() << " " << Results.Get<1>() << " " << Results.Get<2>() << std::endl; // 299999995 fast 5
+
+    // Move-only results are moved out of the pool tasks
+    auto Owned = when_all(htuple {
+        [] { return std::make_unique<int>(3); },
+        [] { return std::make_unique<std::string>("owned"); },
+    });
+    std::cout << "Owned: " << *Owned.GetRef<0>() << " " << *Owned.GetRef<1>() << std::endl; // 3 owned
+
+    try
+    {
+        when_all(htuple {
+            [] { return SlowSum(1000); },
+            []() -> int { throw std::runtime_error("task failed"); },
+        });
+    } catch (const std::exception& Error)
+    {
+        std::cout << "Error: " << Error.what() << std::endl; // task failed
+    }
+
+    htuple<long long, long long, long long> Counts { 10, 1000, 10000000 };
+    parallel_for_each(Counts, [](long long& Count) { Count = SlowSum(Count); });
+    std::cout << "Sums: " << Counts.Get<0>() << " " << Counts.Get<1>() << " " << Counts.Get<2>() << std::endl; // 24 2997 29999994
+}
+#endif
@@ -0,0 +1,336 @@
+// github.com/broly/CppFun
+// This is minimal work-stealing thread pool
+// Each worker has its own queue: it takes own tasks from the back (hot in cache) and steals from the front of others
+// Waiting thread doesn't sleep while there are pending tasks, it helps to run them (so nested waits don't deadlock)
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class work_stealing_pool
+{
+public:
+    using task = std::function<void()>;
+
+    explicit work_stealing_pool(size_t ThreadCount = std::max(1u, std::thread::hardware_concurrency()))
+        : Queues(std::max<size_t>(ThreadCount, 1))
+    {
+        for (size_t i = 0; i < Queues.size(); ++i)
+        {
+            Workers.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool()
+    {
+        {
+            std::lock_guard Lock(SleepMutex);
+            bStop = true;
+        }
+        SleepCondition.notify_all();
+        for (std::thread& Worker : Workers)
+        {
+            Worker.join();
+        }
+    }
+
+    // Shared pool with one worker per core
+    static work_stealing_pool& Default()
+    {
+        static work_stealing_pool Pool;
+        return Pool;
+    }
+
+    // Pushes task to the queue of current worker (or to the next queue for external threads)
+    void Submit(task Task)
+    {
+        const size_t Index = CurrentPool == this ? CurrentQueue : NextQueue.fetch_add(1, std::memory_order_relaxed) % Queues.size();
+        Pending.fetch_add(1);
+        {
+            std::lock_guard Lock(Queues[Index].Mutex);
+            Queues[Index].Tasks.push_back(std::move(Task));
+        }
+
+        // Sleep mutex is touched only when some worker sleeps
+        // (`Pending` and `Sleeping` are sequentially consistent: either sleeper sees the task or we see the sleeper)
+        if (Sleeping.load() > 0)
+        {
+            {
+                std::lock_guard Lock(SleepMutex);
+            }
+            SleepCondition.notify_one();
+        }
+    }
+
+    // Runs one pending task on calling thread
+    // Returns false if there were no tasks
+    bool RunPending()
+    {
+        task Task;
+        if (!TakeTask(CurrentPool == this ? CurrentQueue : 0, Task))
+        {
+            return false;
+        }
+        Task();
+        return true;
+    }
+
+    size_t size() const
+    {
+        return Workers.size();
+    }
+
+private:
+    // Padded to own cache line, so workers don't bounce each other's queues
+    struct alignas(64) worker_queue
+    {
+        std::mutex Mutex;
+        std::deque<task> Tasks;
+    };
+
+    // Own queue first (LIFO), then steal from others (FIFO)
+    bool TakeTask(size_t Own, task& OutTask)
+    {
+        for (size_t i = 0; i < Queues.size(); ++i)
+        {
+            worker_queue& Queue = Queues[(Own + i) % Queues.size()];
+            std::lock_guard Lock(Queue.Mutex);
+            if (!Queue.Tasks.empty())
+            {
+                if (i == 0)
+                {
+                    OutTask = std::move(Queue.Tasks.back());
+                    Queue.Tasks.pop_back();
+                } else
+                {
+                    OutTask = std::move(Queue.Tasks.front());
+                    Queue.Tasks.pop_front();
+                }
+
+                Pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t Index)
+    {
+        CurrentPool = this;
+        CurrentQueue = Index;
+
+        task Task;
+        while (true)
+        {
+            if (TakeTask(Index, Task))
+            {
+                Task();
+                Task = nullptr;
+                continue;
+            }
+
+            std::unique_lock Lock(SleepMutex);
+            Sleeping.fetch_add(1);
+            SleepCondition.wait(Lock, [this] { return bStop || Pending.load() > 0; });
+            Sleeping.fetch_sub(1);
+            if (bStop && Pending.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    std::vector<worker_queue> Queues;
+    std::vector<std::thread> Workers;
+    std::atomic<size_t> NextQueue = 0;
+
+    // Count of submitted but not taken tasks (hint for sleeping workers)
+    alignas(64) std::atomic<size_t> Pending = 0;
+    std::atomic<size_t> Sleeping = 0;
+
+    std::mutex SleepMutex;
+    std::condition_variable SleepCondition;
+    bool bStop = false;
+
+    static inline thread_local work_stealing_pool* CurrentPool = nullptr;
+    static inline thread_local size_t CurrentQueue = 0;
+};
+
+// Group of tasks that are waited together
+// Wait helps to run pending tasks and rethrows the first exception thrown by a task
+class task_group
+{
+public:
+    explicit task_group(work_stealing_pool& InPool = work_stealing_pool::Default())
+        : Pool(InPool)
+    {}
+
+    task_group(const task_group&) = delete;
+
+    ~task_group()
+    {
+        WaitAll();
+    }
+
+    template<typename F>
+    void Run(F&& Func)
+    {
+        {
+            std::lock_guard Lock(Mutex);
+            ++Remaining;
+        }
+        Pool.Submit([this, Func = std::forward<F>(Func)]() mutable
+        {
+            std::exception_ptr TaskError;
+            try
+            {
+                Func();
+            } catch (...)
+            {
+                TaskError = std::current_exception();
+            }
+
+            // Group may be destroyed right after the last task is done, so notify under lock
+            std::lock_guard Lock(Mutex);
+            if (TaskError && !Error)
+            {
+                Error = TaskError;
+            }
+            if (--Remaining == 0)
+            {
+                Done.notify_all();
+            }
+        });
+    }
+
+    void Wait()
+    {
+        WaitAll();
+        if (Error)
+        {
+            std::rethrow_exception(std::exchange(Error, nullptr));
+        }
+    }
+
+private:
+    void WaitAll()
+    {
+        while (true)
+        {
+            {
+                std::lock_guard Lock(Mutex);
+                if (Remaining == 0)
+                {
+                    return;
+                }
+            }
+
+            // Help to run tasks, sleep only when there is nothing to run
+            if (!Pool.RunPending())
+            {
+                std::unique_lock Lock(Mutex);
+                Done.wait(Lock, [this] { return Remaining == 0; });
+                return;
+            }
+        }
+    }
+
+    work_stealing_pool& Pool;
+    std::mutex Mutex;
+    std::condition_variable Done;
+    size_t Remaining = 0;
+    std::exception_ptr Error;
+};
+
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
+
+// Deliberately unbalanced work: cost of task grows with its index
+uint64_t Spin(uint64_t Count)
+{
+    uint64_t Value = Count;
+    for (uint64_t i = 0; i < Count; ++i)
+    {
+        Value = Value * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    return Value;
+}
+
+// Same unbalanced task set on 1, 2, 4, ... N workers
+void BenchmarkScaling()
+{
+    constexpr uint64_t TaskCount = 2000;
+
+    double SingleMilliseconds = 0;
+    const size_t MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t Threads = 1;; Threads = std::min(Threads * 2, MaxThreads))
+    {
+        work_stealing_pool Pool(Threads);
+        std::atomic<uint64_t> Checksum = 0;
+
+        const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        {
+            task_group Group(Pool);
+            for (uint64_t i = 0; i < TaskCount; ++i)
+            {
+                Group.Run([&Checksum, i] { Checksum.fetch_add(Spin(i * 100), std::memory_order_relaxed); });
+            }
+            Group.Wait();
+        }
+        const double Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+
+        SingleMilliseconds = Threads == 1 ? Milliseconds : SingleMilliseconds;
+        std::cout << "Threads: " << Threads << ", " << Milliseconds << " ms, speedup: " << SingleMilliseconds / Milliseconds << std::endl;
+
+        if (Threads == MaxThreads)
+        {
+            break;
+        }
+    }
+}
+
+int main()
+{
+    work_stealing_pool Pool(4);
+
+    std::atomic<int> Sum = 0;
+    {
+        task_group Group(Pool);
+        for (int i = 1; i <= 100; ++i)
+        {
+            Group.Run([&Sum, i] { Sum += i; });
+        }
+        Group.Wait();
+    }
+    std::cout << "Sum: " << Sum << std::endl; // 5050
+
+    try
+    {
+        task_group Group(Pool);
+        Group.Run([] { throw std::runtime_error("task failed"); });
+        Group.Wait();
+    } catch (const std::exception& Error)
+    {
+        std::cout << "Error: " << Error.what() << std::endl; // task failed
+    }
+
+    BenchmarkScaling();
+}
+#endif
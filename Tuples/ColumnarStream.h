@@ -0,0 +1,622 @@
+// github.com/broly/CppFun
+// This is compressed columnar stream of tuple records (htuple, vtuple, minituple)
+// Records are split into blocks, each block stores one column per tuple element, codec of column is chosen by element type:
+//   integers    - delta to previous value, zig-zag, varint
+//   floats      - XOR with previous value, only meaningful bytes are stored
+//   bool        - bit-packing
+//   std::string - block dictionary and varint indices
+// Reader decodes one block at a time, so memory is bounded by block size regardless of stream length
+// Sizes read from the stream are checked against the header and reader limits before anything is allocated, so corrupted input throws std::runtime_error
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define COLUMNAR_STREAM_DEMO
+#endif
+
+#include "HorizontalTuple.h"
+#include "VerticalTuple.h"
+#include "MiniTuple.h"
+
+#ifdef COLUMNAR_STREAM_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+namespace detail
+{
+    using byte_buffer = std::vector<uint8_t>;
+
+    inline void write_varint(byte_buffer& Out, uint64_t Value)
+    {
+        while (Value >= 0x80)
+        {
+            Out.push_back(uint8_t(Value) | 0x80);
+            Value >>= 7;
+        }
+        Out.push_back(uint8_t(Value));
+    }
+
+    inline uint64_t zigzag(int64_t Value)
+    {
+        return (uint64_t(Value) << 1) ^ uint64_t(Value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t Value)
+    {
+        return int64_t(Value >> 1) ^ -int64_t(Value & 1);
+    }
+
+    // Cursor over encoded block, throws on truncated or corrupted data
+    struct byte_reader
+    {
+        const uint8_t* Ptr;
+        const uint8_t* End;
+
+        uint8_t Byte()
+        {
+            if (Ptr == End)
+            {
+                throw std::runtime_error("columnar stream: unexpected end of block");
+            }
+            return *Ptr++;
+        }
+
+        uint64_t Varint()
+        {
+            uint64_t Value = 0;
+            for (int Shift = 0; Shift < 64; Shift += 7)
+            {
+                const uint8_t Next = Byte();
+                Value |= uint64_t(Next & 0x7F) << Shift;
+                if (!(Next & 0x80))
+                {
+                    return Value;
+                }
+            }
+            throw std::runtime_error("columnar stream: bad varint");
+        }
+
+        size_t Remaining() const
+        {
+            return size_t(End - Ptr);
+        }
+
+        const uint8_t* Bytes(size_t Count)
+        {
+            if (Remaining() < Count)
+            {
+                throw std::runtime_error("columnar stream: unexpected end of block");
+            }
+            const uint8_t* Result = Ptr;
+            Ptr += Count;
+            return Result;
+        }
+    };
+
+    // Column codec
+    // Encode(Column, Out)      - appends encoded column to Out
+    // Decode(In, Column)       - fills already sized Column
+    template<typename T>
+    struct column_codec
+    {
+        static_assert(sizeof(T) == 0, "No columnar codec for this element type");
+    };
+
+    // Delta + zig-zag + varint (sorted ids and timestamps become one byte per value)
+    template<typename T>
+        requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+    struct column_codec<T>
+    {
+        static void Encode(const std::vector<T>& Column, byte_buffer& Out)
+        {
+            // Signed values are sign-extended, so delta of any two values fits in uint64 arithmetic
+            uint64_t Prev = 0;
+            for (const T Value : Column)
+            {
+                write_varint(Out, zigzag(int64_t(uint64_t(Value) - Prev)));
+                Prev = uint64_t(Value);
+            }
+        }
+
+        static void Decode(byte_reader& In, std::vector<T>& Column)
+        {
+            uint64_t Prev = 0;
+            for (T& Value : Column)
+            {
+                Prev += uint64_t(unzigzag(In.Varint()));
+                Value = T(Prev);
+            }
+        }
+    };
+
+    // XOR with previous value (byte-granular Gorilla)
+    // Header byte: leading zero bytes in high nibble, trailing zero bytes in low nibble, 0xFF for equal values
+    template<typename T>
+        requires std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559
+    struct column_codec<T>
+    {
+        using bits_type = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+        static constexpr uint8_t SameValue = 0xFF;
+
+        static void Encode(const std::vector<T>& Column, byte_buffer& Out)
+        {
+            bits_type Prev = 0;
+            for (const T Value : Column)
+            {
+                const bits_type Bits = std::bit_cast<bits_type>(Value);
+                const bits_type Xor = Bits ^ Prev;
+                Prev = Bits;
+
+                if (Xor == 0)
+                {
+                    Out.push_back(SameValue);
+                    continue;
+                }
+
+                const int Leading = std::countl_zero(Xor) / 8;
+                const int Trailing = std::countr_zero(Xor) / 8;
+                Out.push_back(uint8_t(Leading << 4 | Trailing));
+                for (int Byte = Trailing; Byte < int(sizeof(T)) - Leading; ++Byte)
+                {
+                    Out.push_back(uint8_t(Xor >> (Byte * 8)));
+                }
+            }
+        }
+
+        static void Decode(byte_reader& In, std::vector<T>& Column)
+        {
+            bits_type Prev = 0;
+            for (T& Value : Column)
+            {
+                const uint8_t Header = In.Byte();
+                if (Header != SameValue)
+                {
+                    const int Leading = Header >> 4;
+                    const int Trailing = Header & 0xF;
+                    if (Leading + Trailing >= int(sizeof(T)))
+                    {
+                        throw std::runtime_error("columnar stream: bad float header");
+                    }
+
+                    bits_type Xor = 0;
+                    for (int Byte = Trailing; Byte < int(sizeof(T)) - Leading; ++Byte)
+                    {
+                        Xor |= bits_type(In.Byte()) << (Byte * 8);
+                    }
+                    Prev ^= Xor;
+                }
+                Value = std::bit_cast<T>(Prev);
+            }
+        }
+    };
+
+    // Eight values per byte
+    template<>
+    struct column_codec<bool>
+    {
+        static void Encode(const std::vector<bool>& Column, byte_buffer& Out)
+        {
+            for (size_t i = 0; i < Column.size(); i += 8)
+            {
+                uint8_t Packed = 0;
+                for (size_t Bit = 0; Bit < 8 && i + Bit < Column.size(); ++Bit)
+                {
+                    Packed |= uint8_t(Column[i + Bit]) << Bit;
+                }
+                Out.push_back(Packed);
+            }
+        }
+
+        static void Decode(byte_reader& In, std::vector<bool>& Column)
+        {
+            const uint8_t* Packed = In.Bytes((Column.size() + 7) / 8);
+            for (size_t i = 0; i < Column.size(); ++i)
+            {
+                Column[i] = (Packed[i / 8] >> (i % 8)) & 1;
+            }
+        }
+    };
+
+    // Dictionary of distinct strings in block, then varint index per value
+    template<>
+    struct column_codec<std::string>
+    {
+        static void Encode(const std::vector<std::string>& Column, byte_buffer& Out)
+        {
+            std::unordered_map<std::string_view, uint32_t> Indices;
+            std::vector<std::string_view> Dictionary;
+            std::vector<uint32_t> Values;
+            Values.reserve(Column.size());
+            for (const std::string& Value : Column)
+            {
+                const auto [It, bInserted] = Indices.try_emplace(Value, uint32_t(Dictionary.size()));
+                if (bInserted)
+                {
+                    Dictionary.push_back(Value);
+                }
+                Values.push_back(It->second);
+            }
+
+            write_varint(Out, Dictionary.size());
+            for (const std::string_view Entry : Dictionary)
+            {
+                write_varint(Out, Entry.size());
+                Out.insert(Out.end(), Entry.begin(), Entry.end());
+            }
+            for (const uint32_t Index : Values)
+            {
+                write_varint(Out, Index);
+            }
+        }
+
+        static void Decode(byte_reader& In, std::vector<std::string>& Column)
+        {
+            // Every entry takes at least one byte and no block has more distinct strings than values
+            const uint64_t DictionarySize = In.Varint();
+            if (DictionarySize > Column.size() || DictionarySize > In.Remaining())
+            {
+                throw std::runtime_error("columnar stream: bad dictionary size");
+            }
+
+            std::vector<std::string> Dictionary(DictionarySize);
+            for (std::string& Entry : Dictionary)
+            {
+                const size_t Size = In.Varint();
+                const uint8_t* Chars = In.Bytes(Size);
+                Entry.assign(reinterpret_cast<const char*>(Chars), Size);
+            }
+            for (std::string& Value : Column)
+            {
+                const uint64_t Index = In.Varint();
+                if (Index >= Dictionary.size())
+                {
+                    throw std::runtime_error("columnar stream: bad dictionary index");
+                }
+                Value = Dictionary[Index];
+            }
+        }
+    };
+
+    // Stream starts with magic, column count and block size
+    inline constexpr char columnar_magic[4] = { 'C', 'F', 'C', '2' };
+
+    // Largest block (in records) writer may produce and reader accepts
+    inline constexpr size_t columnar_max_block_size = 1 << 20;
+
+    inline bool read_varint(std::istream& Stream, uint64_t& OutValue)
+    {
+        OutValue = 0;
+        for (int Shift = 0; Shift < 64; Shift += 7)
+        {
+            const int Next = Stream.get();
+            if (Next == std::char_traits<char>::eof())
+            {
+                return false;
+            }
+            OutValue |= uint64_t(Next & 0x7F) << Shift;
+            if (!(Next & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// Stream layout:
+//   magic, column count, block size (varint)
+//   blocks: record count (varint), payload size (varint), columns one after another
+//   end: record count 0
+template<typename Tuple>
+class columnar_writer;
+
+template<template<typename...> typename TupleType, typename... Ts>
+class columnar_writer<TupleType<Ts...>>
+{
+public:
+    // BlockSize - count of records in one block (reader keeps one block in memory), 1..columnar_max_block_size
+    explicit columnar_writer(std::ostream& InStream, size_t InBlockSize = 4096)
+        : Stream(InStream)
+        , BlockSize(InBlockSize)
+        , Columns(std::vector<Ts>{}...)
+    {
+        if (BlockSize == 0 || BlockSize > detail::columnar_max_block_size)
+        {
+            throw std::invalid_argument("columnar stream: bad block size");
+        }
+
+        Stream.write(detail::columnar_magic, sizeof(detail::columnar_magic));
+        Stream.put(char(sizeof...(Ts)));
+        detail::write_varint(Header, BlockSize);
+        Stream.write(reinterpret_cast<const char*>(Header.data()), Header.size());
+    }
+
+    columnar_writer(const columnar_writer&) = delete;
+
+    ~columnar_writer()
+    {
+        Finish();
+    }
+
+    void Write(TupleType<Ts...> Record)
+    {
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            (Columns.template GetRef<Indices>().push_back(std::move(Record.template GetRef<Indices>())), ...);
+        }(std::index_sequence_for<Ts...>{});
+
+        if (++Count == BlockSize)
+        {
+            Flush();
+        }
+    }
+
+    // Writes buffered records as a (possibly smaller) block
+    void Flush()
+    {
+        if (Count == 0)
+        {
+            return;
+        }
+
+        Payload.clear();
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            ((detail::column_codec<Ts>::Encode(Columns.template GetRef<Indices>(), Payload), Columns.template GetRef<Indices>().clear()), ...);
+        }(std::index_sequence_for<Ts...>{});
+
+        Header.clear();
+        detail::write_varint(Header, Count);
+        detail::write_varint(Header, Payload.size());
+        Stream.write(reinterpret_cast<const char*>(Header.data()), Header.size());
+        Stream.write(reinterpret_cast<const char*>(Payload.data()), Payload.size());
+        Count = 0;
+    }
+
+    // Flushes and writes end marker, called by destructor
+    void Finish()
+    {
+        if (bFinished)
+        {
+            return;
+        }
+        Flush();
+        Stream.put(0);
+        bFinished = true;
+    }
+
+private:
+    std::ostream& Stream;
+    size_t BlockSize;
+    size_t Count = 0;
+    bool bFinished = false;
+    htuple<std::vector<Ts>...> Columns;
+    detail::byte_buffer Header;
+    detail::byte_buffer Payload;
+};
+
+template<typename Tuple>
+class columnar_reader;
+
+template<template<typename...> typename TupleType, typename... Ts>
+class columnar_reader<TupleType<Ts...>>
+{
+public:
+    // MaxPayloadBytes - largest encoded block reader agrees to buffer
+    explicit columnar_reader(std::istream& InStream, size_t InMaxPayloadBytes = 64 * 1024 * 1024)
+        : Stream(InStream)
+        , MaxPayloadBytes(InMaxPayloadBytes)
+        , Columns(std::vector<Ts>{}...)
+    {
+        char Magic[sizeof(detail::columnar_magic)];
+        Stream.read(Magic, sizeof(Magic));
+        if (!Stream || std::memcmp(Magic, detail::columnar_magic, sizeof(Magic)) != 0 || Stream.get() != int(sizeof...(Ts)))
+        {
+            throw std::runtime_error("columnar stream: bad header");
+        }
+
+        uint64_t InBlockSize = 0;
+        if (!detail::read_varint(Stream, InBlockSize) || InBlockSize == 0 || InBlockSize > detail::columnar_max_block_size)
+        {
+            throw std::runtime_error("columnar stream: bad block size");
+        }
+        BlockSize = InBlockSize;
+    }
+
+    // Reads next record, returns false at the end of stream (and on every call after it)
+    bool Read(TupleType<Ts...>& OutRecord)
+    {
+        if (bEnd)
+        {
+            return false;
+        }
+        if (Cursor == Count && !ReadBlock())
+        {
+            return false;
+        }
+
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            OutRecord = TupleType<Ts...>(std::move(Columns.template GetRef<Indices>()[Cursor])...);
+        }(std::index_sequence_for<Ts...>{});
+        ++Cursor;
+        return true;
+    }
+
+private:
+    bool ReadBlock()
+    {
+        uint64_t RecordCount = 0;
+        uint64_t PayloadSize = 0;
+        if (!detail::read_varint(Stream, RecordCount))
+        {
+            throw std::runtime_error("columnar stream: missing end marker");
+        }
+        if (RecordCount == 0)
+        {
+            bEnd = true;
+            return false;
+        }
+        if (RecordCount > BlockSize)
+        {
+            throw std::runtime_error("columnar stream: block is bigger than block size");
+        }
+        if (!detail::read_varint(Stream, PayloadSize))
+        {
+            throw std::runtime_error("columnar stream: unexpected end of stream");
+        }
+        if (PayloadSize > MaxPayloadBytes)
+        {
+            throw std::runtime_error("columnar stream: block payload is too big");
+        }
+
+        Payload.resize(PayloadSize);
+        Stream.read(reinterpret_cast<char*>(Payload.data()), PayloadSize);
+        if (size_t(Stream.gcount()) != PayloadSize)
+        {
+            throw std::runtime_error("columnar stream: unexpected end of stream");
+        }
+
+        detail::byte_reader In { Payload.data(), Payload.data() + Payload.size() };
+        [&]<size_t... Indices>(std::index_sequence<Indices...>)
+        {
+            ((Columns.template GetRef<Indices>().resize(RecordCount), detail::column_codec<Ts>::Decode(In, Columns.template GetRef<Indices>())), ...);
+        }(std::index_sequence_for<Ts...>{});
+
+        Count = RecordCount;
+        Cursor = 0;
+        return true;
+    }
+
+    std::istream& Stream;
+    size_t MaxPayloadBytes;
+    size_t BlockSize = 0;
+    size_t Count = 0;
+    size_t Cursor = 0;
+    bool bEnd = false;
+    htuple<std::vector<Ts>...> Columns;
+    detail::byte_buffer Payload;
+};
+
+#ifdef COLUMNAR_STREAM_DEMO
+    #undef COLUMNAR_STREAM_DEMO
+
+using trade = htuple<int64_t, uint32_t, double, bool, std::string>;
+
+// Uncompressed baseline: fields one after another, string as uint32 length and chars
+void WriteRaw(std::ostream& Stream, const trade& Trade)
+{
+    const uint32_t VenueSize = uint32_t(Trade.GetRef<4>().size());
+    Stream.write(reinterpret_cast<const char*>(&Trade.GetRef<0>()), sizeof(int64_t));
+    Stream.write(reinterpret_cast<const char*>(&Trade.GetRef<1>()), sizeof(uint32_t));
+    Stream.write(reinterpret_cast<const char*>(&Trade.GetRef<2>()), sizeof(double));
+    Stream.write(reinterpret_cast<const char*>(&Trade.GetRef<3>()), sizeof(bool));
+    Stream.write(reinterpret_cast<const char*>(&VenueSize), sizeof(uint32_t));
+    Stream.write(Trade.GetRef<4>().data(), VenueSize);
+}
+
+bool ReadRaw(std::istream& Stream, trade& Trade)
+{
+    uint32_t VenueSize = 0;
+    Stream.read(reinterpret_cast<char*>(&Trade.GetRef<0>()), sizeof(int64_t));
+    Stream.read(reinterpret_cast<char*>(&Trade.GetRef<1>()), sizeof(uint32_t));
+    Stream.read(reinterpret_cast<char*>(&Trade.GetRef<2>()), sizeof(double));
+    Stream.read(reinterpret_cast<char*>(&Trade.GetRef<3>()), sizeof(bool));
+    Stream.read(reinterpret_cast<char*>(&VenueSize), sizeof(uint32_t));
+    Trade.GetRef<4>().resize(VenueSize);
+    Stream.read(Trade.GetRef<4>().data(), VenueSize);
+    return bool(Stream);
+}
+
+int main()
+{
+    const char* Venues[] = { "NASDAQ", "NYSE", "LSE", "XETRA" };
+
+    constexpr size_t RecordCount = 1000000;
+    std::vector<trade> Trades;
+    Trades.reserve(RecordCount);
+    size_t RawSize = 0;
+    for (size_t i = 0; i < RecordCount; ++i)
+    {
+        // Timestamp, instrument, price, side, venue
+        Trades.push_back(trade(1700000000000 + int64_t(i) * 15, uint32_t(i % 500), 100.0 + double(i % 64) * 0.25, i % 3 == 0, Venues[i % 4]));
+        RawSize += sizeof(int64_t) + sizeof(uint32_t) + sizeof(double) + sizeof(bool) + sizeof(uint32_t) + Trades.back().GetRef<4>().size();
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::stringstream Stream;
+
+    const clock::time_point WriteStart = clock::now();
+    {
+        columnar_writer<trade> Writer(Stream);
+        for (const trade& Trade : Trades)
+        {
+            Writer.Write(Trade);
+        }
+    }
+    const double WriteSeconds = std::chrono::duration<double>(clock::now() - WriteStart).count();
+
+    const size_t CompressedSize = Stream.str().size();
+    std::cout << "Raw: " << RawSize << " bytes, columnar: " << CompressedSize << " bytes, ratio: " << double(RawSize) / double(CompressedSize) << std::endl;
+
+    const clock::time_point ReadStart = clock::now();
+    columnar_reader<trade> Reader(Stream);
+    trade Trade(0, 0, 0.0, false, "");
+    size_t Mismatches = 0;
+    for (size_t i = 0; Reader.Read(Trade); ++i)
+    {
+        Mismatches += Trade.GetRef<0>() != Trades[i].GetRef<0>() || Trade.GetRef<2>() != Trades[i].GetRef<2>() || Trade.GetRef<4>() != Trades[i].GetRef<4>();
+    }
+    const double ReadSeconds = std::chrono::duration<double>(clock::now() - ReadStart).count();
+
+    std::cout << "Mismatches: " << Mismatches << ", read after end: " << Reader.Read(Trade) << std::endl; // 0, 0
+    std::cout << "Write (columnar): " << double(RawSize) / WriteSeconds / 1e6 << " MB/s, read (columnar): " << double(RawSize) / ReadSeconds / 1e6 << " MB/s" << std::endl;
+
+    // The same records dumped uncompressed
+    std::stringstream RawStream;
+    const clock::time_point RawWriteStart = clock::now();
+    for (const trade& Record : Trades)
+    {
+        WriteRaw(RawStream, Record);
+    }
+    const double RawWriteSeconds = std::chrono::duration<double>(clock::now() - RawWriteStart).count();
+
+    const clock::time_point RawReadStart = clock::now();
+    size_t RawMismatches = 0;
+    for (size_t i = 0; ReadRaw(RawStream, Trade); ++i)
+    {
+        RawMismatches += Trade.GetRef<0>() != Trades[i].GetRef<0>() || Trade.GetRef<2>() != Trades[i].GetRef<2>() || Trade.GetRef<4>() != Trades[i].GetRef<4>();
+    }
+    const double RawReadSeconds = std::chrono::duration<double>(clock::now() - RawReadStart).count();
+
+    std::cout << "Write (raw): " << double(RawSize) / RawWriteSeconds / 1e6 << " MB/s, read (raw): " << double(RawSize) / RawReadSeconds / 1e6 << " MB/s, raw mismatches: " << RawMismatches << std::endl; // ... 0
+
+    // Corrupted block header claims 2^35 records, reader refuses it instead of allocating
+    std::stringstream Corrupted(Stream.str().substr(0, 7) + "\x80\x80\x80\x80\x80\x01");
+    try
+    {
+        columnar_reader<trade> BadReader(Corrupted);
+        BadReader.Read(Trade);
+    } catch (const std::runtime_error& Error)
+    {
+        std::cout << "Corrupted: " << Error.what() << std::endl; // columnar stream: block is bigger than block size
+    }
+}
+#endif
@@ -1,6 +1,11 @@
 // github.com/broly/CppFun
 // This is minimal as possible horizontal tuple implementation
+
+#pragma once
+
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 template<typename... Ts>
 struct htuple;
@@ -12,7 +17,13 @@ namespace detail
 	struct htuple_elem
 	{
 		constexpr htuple_elem(ElemType InValue)
-			: Value(InValue)
+			: Value(std::forward<ElemType>(InValue))
+		{}
+
+		// Passes allocator to the value if its type accepts one
+		template<typename Alloc, typename U>
+		constexpr htuple_elem(std::allocator_arg_t, const Alloc& Allocator, U&& InValue)
+			: Value(std::make_obj_using_allocator<ElemType>(Allocator, std::forward<U>(InValue)))
 		{}
 		ElemType Value;
 		static constexpr size_t Index = ElemIndex;
@@ -33,6 +44,18 @@ namespace detail
             {
                 return Tup.Value;
             }
+
+            template<typename DeducedType>
+            static DeducedType& GetRef(htuple_elem<DeducedType, Index>& Tup)
+            {
+                return Tup.Value;
+            }
+
+            template<typename DeducedType>
+            static const DeducedType& GetRef(const htuple_elem<DeducedType, Index>& Tup)
+            {
+                return Tup.Value;
+            }
         };
 	}
 	
@@ -40,8 +63,26 @@ namespace detail
 	template<typename... Ts, size_t... Indices>
 	struct htuple_impl<std::index_sequence<Indices...>, Ts...> : htuple_elem<Ts, Indices>...
 	{
-		constexpr htuple_impl(const Ts&... InValues)
-			: htuple_elem<Ts, Indices>(InValues)...
+		// Values are moved through (so move-only element types work)
+		constexpr htuple_impl(Ts... InValues)
+			: htuple_elem<Ts, Indices>(std::forward<Ts>(InValues))...
+		{}
+
+		// Each element is constructed in place from its argument (a tuple passed as the only argument goes to copy/move below)
+		template<typename Alloc, typename... Us>
+			requires (sizeof...(Us) == sizeof...(Ts) && (sizeof...(Us) != 1 || (!std::is_base_of_v<htuple_impl, std::remove_cvref_t<Us>> && ...)))
+		constexpr htuple_impl(std::allocator_arg_t, const Alloc& Allocator, Us&&... InValues)
+			: htuple_elem<Ts, Indices>(std::allocator_arg, Allocator, std::forward<Us>(InValues))...
+		{}
+
+		template<typename Alloc>
+		constexpr htuple_impl(std::allocator_arg_t, const Alloc& Allocator, const htuple_impl& Other)
+			: htuple_elem<Ts, Indices>(std::allocator_arg, Allocator, static_cast<const htuple_elem<Ts, Indices>&>(Other).Value)...
+		{}
+
+		template<typename Alloc>
+		constexpr htuple_impl(std::allocator_arg_t, const Alloc& Allocator, htuple_impl&& Other)
+			: htuple_elem<Ts, Indices>(std::allocator_arg, Allocator, std::move(static_cast<htuple_elem<Ts, Indices>&>(Other).Value))...
 		{}
 		
 		static constexpr size_t size = sizeof...(Ts);
@@ -52,6 +93,19 @@ namespace detail
             return helpers::elem_getter<Index>::Get(*this);
 		}
 
+		// Access to the element itself (not a copy)
+		template<size_t Index>
+		auto& GetRef()
+		{
+            return helpers::elem_getter<Index>::GetRef(*this);
+		}
+
+		template<size_t Index>
+		const auto& GetRef() const
+		{
+            return helpers::elem_getter<Index>::GetRef(*this);
+		}
+
 		template<size_t Index = 0>
 		auto GetLast()
 		{
@@ -65,14 +119,42 @@ template<typename... Ts>
 struct htuple : detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>
 {
 	constexpr htuple(Ts... Vs)
-		: detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>(Vs...)
+		: detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>(std::forward<Ts>(Vs)...)
+	{}
+
+	// Allocator-extended constructors (allocator is passed to each element that accepts it)
+	// Elements are constructed in place from forwarded arguments, so `htuple<std::pmr::string>(std::allocator_arg, Alloc, "text")` makes no temporary string
+	template<typename Alloc, typename... Us>
+		requires (sizeof...(Us) == sizeof...(Ts) && (sizeof...(Us) != 1 || (!std::is_base_of_v<htuple, std::remove_cvref_t<Us>> && ...)))
+	constexpr htuple(std::allocator_arg_t, const Alloc& Allocator, Us&&... Vs)
+		: detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>(std::allocator_arg, Allocator, std::forward<Us>(Vs)...)
+	{}
+
+	template<typename Alloc>
+	constexpr htuple(std::allocator_arg_t, const Alloc& Allocator, const htuple& Other)
+		: detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>(std::allocator_arg, Allocator, Other)
+	{}
+
+	template<typename Alloc>
+	constexpr htuple(std::allocator_arg_t, const Alloc& Allocator, htuple&& Other)
+		: detail::htuple_impl<std::make_index_sequence<sizeof...(Ts)>, Ts...>(std::allocator_arg, Allocator, std::move(Other))
 	{}
 };
 
+template<typename Alloc, typename... Ts>
+htuple(std::allocator_arg_t, Alloc, Ts...) -> htuple<Ts...>;
+
+// Containers pass their allocator to tuple (like to std::tuple)
+template<typename... Ts, typename Alloc>
+struct std::uses_allocator<htuple<Ts...>, Alloc> : std::true_type {};
+
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
 int main()
 {
     htuple tup {33, 2.3f, true, "qwerty"};
     std::cout << "Tuple: " << tup.Get<0>() << " " << tup.Get<1>() << " " << tup.Get<2>() << " " << tup.Get<3>() << std::endl;
     std::cout << "Last: " << tup.GetLast() << std::endl;
     std::cout << "Tuple size: " << tup.size;
-}
\ No newline at end of file
+}
+#endif
@@ -1,6 +1,11 @@
 // github.com/broly/CppFun
 // This is minimal as possible tuple implementation
+
+#pragma once
+
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 template<typename... Ts>
 struct minituple;
@@ -19,6 +24,16 @@ namespace detail
 		{
 			return Data.First;
 		}
+
+		static constexpr auto& GetRef(minituple<T, Ts...>& Data)
+		{
+			return Data.First;
+		}
+
+		static constexpr const auto& GetRef(const minituple<T, Ts...>& Data)
+		{
+			return Data.First;
+		}
 	};
 
 	// Accessing to any element (iter from 'Index' downto 0 and pass 'Rest' tuple for each iteration)
@@ -30,6 +45,16 @@ namespace detail
 		{
 			return GetHelper<Index - 1, minituple<Ts ...>>::Get(Data.Rest);
 		}
+
+		static constexpr auto& GetRef(minituple<T, Ts...>& Data)
+		{
+			return GetHelper<Index - 1, minituple<Ts ...>>::GetRef(Data.Rest);
+		}
+
+		static constexpr const auto& GetRef(const minituple<T, Ts...>& Data)
+		{
+			return GetHelper<Index - 1, minituple<Ts ...>>::GetRef(Data.Rest);
+		}
 	};
 }
 
@@ -41,6 +66,24 @@ struct minituple<T>
 	constexpr minituple(const T& InFirst)
 		: First(InFirst)
 	{}
+
+	// Allocator-extended constructors (allocator is passed to the element if it accepts one)
+	// The element is constructed in place from the argument (a tuple goes to copy/move below)
+	template<typename Alloc, typename U>
+		requires (!std::is_same_v<std::remove_cvref_t<U>, minituple>)
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, U&& InFirst)
+		: First(std::make_obj_using_allocator<T>(Allocator, std::forward<U>(InFirst)))
+	{}
+
+	template<typename Alloc>
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, const minituple& Other)
+		: First(std::make_obj_using_allocator<T>(Allocator, Other.First))
+	{}
+
+	template<typename Alloc>
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, minituple&& Other)
+		: First(std::make_obj_using_allocator<T>(Allocator, std::move(Other.First)))
+	{}
 	
 	T First;
 
@@ -50,6 +93,19 @@ struct minituple<T>
 		return First;
 	}
 
+	// Access to the element itself (not a copy)
+	template<size_t Index>
+	auto& GetRef()
+	{
+		return First;
+	}
+
+	template<size_t Index>
+	const auto& GetRef() const
+	{
+		return First;
+	}
+
 	template<size_t Index>
 	auto GetLast()
 	{
@@ -67,6 +123,27 @@ struct minituple<T, Ts...>
 		: First(InFirst)
 		, Rest(InRest...)
 	{}
+
+	// Allocator-extended constructors (allocator is passed to each element that accepts it)
+	// Elements are constructed in place from forwarded arguments
+	template<typename Alloc, typename U, typename... Us>
+		requires (sizeof...(Us) == sizeof...(Ts))
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, U&& InFirst, Us&&... InRest)
+		: First(std::make_obj_using_allocator<T>(Allocator, std::forward<U>(InFirst)))
+		, Rest(std::allocator_arg, Allocator, std::forward<Us>(InRest)...)
+	{}
+
+	template<typename Alloc>
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, const minituple& Other)
+		: First(std::make_obj_using_allocator<T>(Allocator, Other.First))
+		, Rest(std::allocator_arg, Allocator, Other.Rest)
+	{}
+
+	template<typename Alloc>
+	constexpr minituple(std::allocator_arg_t, const Alloc& Allocator, minituple&& Other)
+		: First(std::make_obj_using_allocator<T>(Allocator, std::move(Other.First)))
+		, Rest(std::allocator_arg, Allocator, std::move(Other.Rest))
+	{}
 	
 	T First;
 	minituple<Ts...> Rest;
@@ -77,6 +154,19 @@ struct minituple<T, Ts...>
 		return detail::GetHelper<Index, minituple<T, Ts...>>::Get(*this);
 	}
 
+	// Access to the element itself (not a copy)
+	template<size_t Index>
+	auto& GetRef()
+	{
+		return detail::GetHelper<Index, minituple<T, Ts...>>::GetRef(*this);
+	}
+
+	template<size_t Index>
+	const auto& GetRef() const
+	{
+		return detail::GetHelper<Index, minituple<T, Ts...>>::GetRef(*this);
+	}
+
 	template<size_t Index = 0>
 	auto GetLast()
 	{
@@ -96,6 +186,12 @@ struct minituple<>
 	static constexpr size_t size = 0;
 };
 
+// Containers pass their allocator to tuple (like to std::tuple)
+template<typename... Ts, typename Alloc>
+struct std::uses_allocator<minituple<Ts...>, Alloc> : std::true_type {};
+
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
 int main()
 {
     minituple<int, float, bool, const char*> tup {33, 2.3f, true, "qwerty"};
@@ -104,3 +200,4 @@ int main()
     std::cout << "Last: " << tup.GetLast() << std::endl;
     std::cout << "Tuple size: " << tup.size;
 }
+#endif
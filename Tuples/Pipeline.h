@@ -0,0 +1,276 @@
+// github.com/broly/CppFun
+// This is fused processing pipeline declared as htuple of stages
+// Stages are fused at compile time into one loop body: maps are inlined one into another, filters become early returns,
+// so there are no temporary vectors between stages and no virtual calls
+// Parallel run folds input batch by batch on workers of work-stealing pool (one task per batch) and merges partial results in order
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define PIPELINE_DEMO
+#endif
+
+#include "HorizontalTuple.h"
+#include "../Thread Pool/WorkStealingPool.h"
+
+#ifdef PIPELINE_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+// Stage that drops values for which `Func(Value)` is false
+template<typename F>
+struct filter_stage
+{
+    F Func;
+};
+
+// Stage that replaces value with `Func(Value)` (plain callables are map stages too)
+template<typename F>
+struct map_stage
+{
+    F Func;
+};
+
+namespace detail
+{
+    // Stages get values as lvalues (intermediate values live in the fused loop body), so they may take them by reference
+    template<typename Stage>
+    struct pipeline_stage
+    {
+        static constexpr bool bFilter = false;
+
+        template<typename V>
+        static decltype(auto) Apply(Stage& Func, V& Value)
+        {
+            return Func(Value);
+        }
+    };
+
+    template<typename F>
+    struct pipeline_stage<filter_stage<F>>
+    {
+        static constexpr bool bFilter = true;
+
+        template<typename V>
+        static bool Apply(filter_stage<F>& Stage, V& Value)
+        {
+            return Stage.Func(Value);
+        }
+    };
+
+    template<typename F>
+    struct pipeline_stage<map_stage<F>>
+    {
+        static constexpr bool bFilter = false;
+
+        template<typename V>
+        static decltype(auto) Apply(map_stage<F>& Stage, V& Value)
+        {
+            return Stage.Func(Value);
+        }
+    };
+}
+
+// Fused pipeline
+// Stages are called from several threads at once by parallel `Reduce`, so they must not modify shared state
+template<typename... Stages>
+class pipeline
+{
+public:
+    // BatchBytes - input bytes folded by one task of parallel `Reduce` (granularity of work stealing and of partial results)
+    // Sequential runs need no batches: the fused loop already reads every input value once
+    explicit pipeline(htuple<Stages...> InStages, size_t InBatchBytes = 256 * 1024)
+        : StageTuple(std::move(InStages))
+        , BatchBytes(InBatchBytes)
+    {}
+
+    // Calls `Out(Value)` for each value that passes all stages, in input order
+    template<typename Range, typename Sink>
+    void ForEach(const Range& Input, Sink&& Out)
+    {
+        for (size_t i = 0, Size = std::size(Input); i < Size; ++i)
+        {
+            Push<0>(Input[i], Out);
+        }
+    }
+
+    // Folds output with `Accumulate(Acc&, Value)`
+    template<typename Range, typename Acc, typename Accumulate>
+    Acc Reduce(const Range& Input, Acc Init, Accumulate&& Add)
+    {
+        ForEach(Input, [&](auto&& Value) { Add(Init, std::forward<decltype(Value)>(Value)); });
+        return Init;
+    }
+
+    // Parallel fold: each batch is folded from `Acc{}` by its own pool task, partial results are merged into `Init` in input order with `Merge(Acc&, Acc&&)`
+    // `Acc{}` must be the identity of `Merge` (zero for sums, empty for containers), so `Init` is counted once as in sequential `Reduce`
+    template<typename Range, typename Acc, typename Accumulate, typename Combine>
+    Acc Reduce(const Range& Input, Acc Init, Accumulate&& Add, Combine&& Merge, work_stealing_pool& Pool = work_stealing_pool::Default())
+    {
+        using value_type = std::remove_cvref_t<decltype(Input[0])>;
+
+        const size_t Size = std::size(Input);
+        const size_t BatchSize = std::max<size_t>(BatchBytes / sizeof(value_type), 64);
+        const size_t BatchCount = (Size + BatchSize - 1) / BatchSize;
+
+        std::vector<Acc> Partials(BatchCount, Acc{});
+        {
+            task_group Group(Pool);
+            for (size_t Batch = 0; Batch < BatchCount; ++Batch)
+            {
+                Group.Run([&, Batch]
+                {
+                    // Folded into a local, so neighbouring partials don't share a cache line while workers write them
+                    Acc Partial {};
+                    const size_t End = std::min(Size, (Batch + 1) * BatchSize);
+                    for (size_t i = Batch * BatchSize; i < End; ++i)
+                    {
+                        Push<0>(Input[i], [&](auto&& Value) { Add(Partial, std::forward<decltype(Value)>(Value)); });
+                    }
+                    Partials[Batch] = std::move(Partial);
+                });
+            }
+            Group.Wait();
+        }
+
+        for (Acc& Partial : Partials)
+        {
+            Merge(Init, std::move(Partial));
+        }
+        return Init;
+    }
+
+private:
+    // Passes value through stage `Index` and the rest of the chain
+    template<size_t Index, typename V, typename Sink>
+    void Push(V&& Value, Sink&& Out)
+    {
+        if constexpr (Index == sizeof...(Stages))
+        {
+            Out(std::forward<V>(Value));
+        } else
+        {
+            using stage_type = std::remove_cvref_t<decltype(StageTuple.template GetRef<Index>())>;
+            using traits = detail::pipeline_stage<stage_type>;
+
+            if constexpr (traits::bFilter)
+            {
+                if (!traits::Apply(StageTuple.template GetRef<Index>(), Value))
+                {
+                    return;
+                }
+                Push<Index + 1>(std::forward<V>(Value), Out);
+            } else
+            {
+                Push<Index + 1>(traits::Apply(StageTuple.template GetRef<Index>(), Value), Out);
+            }
+        }
+    }
+
+    htuple<Stages...> StageTuple;
+    size_t BatchBytes;
+};
+
+#ifdef PIPELINE_DEMO
+    #undef PIPELINE_DEMO
+
+// Raw event: user (high 32 bits), amount in cents (bits 1..31), refund flag (bit 0)
+using event = htuple<uint32_t, uint32_t, bool>;
+
+event Parse(uint64_t Raw)
+{
+    return event(uint32_t(Raw >> 32), uint32_t(Raw) >> 1, bool(Raw & 1));
+}
+
+// Regional rate in percents
+uint64_t Enrich(event& Event)
+{
+    constexpr uint64_t Rates[4] = { 100, 120, 95, 110 };
+    return uint64_t(Event.GetRef<1>()) * Rates[Event.GetRef<0>() % 4] / 100;
+}
+
+int main()
+{
+    constexpr size_t RecordCount = 10000000;
+    std::vector<uint64_t> Input(RecordCount);
+    uint64_t Seed = 1;
+    for (uint64_t& Raw : Input)
+    {
+        Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+        Raw = Seed;
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto Milliseconds = [](clock::time_point Start) { return std::chrono::duration<double, std::milli>(clock::now() - Start).count(); };
+
+    // Staged: each stage writes temporary vector
+    clock::time_point Start = clock::now();
+    std::vector<event> Parsed;
+    for (uint64_t Raw : Input)
+    {
+        Parsed.push_back(Parse(Raw));
+    }
+    std::vector<event> Purchases;
+    for (event& Event : Parsed)
+    {
+        if (!Event.GetRef<2>())
+        {
+            Purchases.push_back(Event);
+        }
+    }
+    std::vector<uint64_t> Amounts;
+    for (event& Event : Purchases)
+    {
+        Amounts.push_back(Enrich(Event));
+    }
+    std::vector<uint64_t> Large;
+    for (uint64_t Amount : Amounts)
+    {
+        if (Amount > 100000)
+        {
+            Large.push_back(Amount);
+        }
+    }
+    uint64_t StagedSum = 0;
+    for (uint64_t Amount : Large)
+    {
+        StagedSum += Amount / 100;
+    }
+    std::cout << "Staged: " << StagedSum << " in " << Milliseconds(Start) << " ms" << std::endl;
+
+    // Fused: the same 5 stages in one loop
+    pipeline Pipeline(htuple {
+        map_stage { Parse },
+        filter_stage { [](event& Event) { return !Event.GetRef<2>(); } },
+        map_stage { Enrich },
+        filter_stage { [](uint64_t Amount) { return Amount > 100000; } },
+        map_stage { [](uint64_t Amount) { return Amount / 100; } },
+    });
+
+    auto Add = [](uint64_t& Sum, uint64_t Dollars) { Sum += Dollars; };
+
+    Start = clock::now();
+    const uint64_t FusedSum = Pipeline.Reduce(Input, uint64_t(0), Add);
+    std::cout << "Fused: " << FusedSum << " in " << Milliseconds(Start) << " ms" << std::endl;
+
+    Start = clock::now();
+    const uint64_t ParallelSum = Pipeline.Reduce(Input, uint64_t(0), Add, [](uint64_t& Sum, uint64_t&& Partial) { Sum += Partial; });
+    std::cout << "Fused parallel: " << ParallelSum << " in " << Milliseconds(Start) << " ms" << std::endl;
+
+    // Initial value is counted once by both runs
+    const uint64_t SequentialFrom1000 = Pipeline.Reduce(Input, uint64_t(1000), Add);
+    const uint64_t ParallelFrom1000 = Pipeline.Reduce(Input, uint64_t(1000), Add, [](uint64_t& Sum, uint64_t&& Partial) { Sum += Partial; });
+    std::cout << "Same from 1000: " << (SequentialFrom1000 == ParallelFrom1000 && SequentialFrom1000 == FusedSum + 1000) << std::endl; // 1
+}
+#endif
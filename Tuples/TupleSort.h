@@ -0,0 +1,427 @@
+// github.com/broly/CppFun
+// This is LSD radix sort for arrays of tuples (htuple, vtuple, minituple)
+// Radix order of each key is derived from element type at compile time:
+//   unsigned integers as is, signed integers with flipped sign bit, IEEE floats with flipped sign (and other bits for negatives),
+//   fixed-length strings (std::array<char, N>) byte by byte
+// Sort is stable, keys are given in priority order: sort_by<2, 0> sorts by element 2, then by element 0
+// Works since C++20
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#ifndef CPPFUN_NO_DEMO
+    #define CPPFUN_NO_DEMO
+    #define TUPLE_SORT_DEMO
+#endif
+
+#include "HorizontalTuple.h"
+#include "VerticalTuple.h"
+#include "MiniTuple.h"
+#include "../Thread Pool/WorkStealingPool.h"
+
+#ifdef TUPLE_SORT_DEMO
+    #undef CPPFUN_NO_DEMO
+#endif
+
+// Sort keys (tuple element indices) from the most significant
+template<size_t... KeyIndices>
+struct sort_by {};
+
+namespace detail
+{
+    // Radix representation of key type
+    // Bytes          - count of radix passes
+    // Digit(V, Byte) - byte of order-preserving unsigned representation (0 is the least significant)
+    template<typename T>
+    struct radix_key;
+
+    template<typename T>
+        requires std::is_unsigned_v<T>
+    struct radix_key<T>
+    {
+        static constexpr size_t Bytes = sizeof(T);
+
+        static uint8_t Digit(T Value, size_t Byte)
+        {
+            return uint8_t(Value >> (Byte * 8));
+        }
+    };
+
+    template<typename T>
+        requires std::is_signed_v<T> && std::is_integral_v<T>
+    struct radix_key<T>
+    {
+        using unsigned_type = std::make_unsigned_t<T>;
+
+        static constexpr size_t Bytes = sizeof(T);
+
+        static uint8_t Digit(T Value, size_t Byte)
+        {
+            // Negative values go before positive ones
+            const unsigned_type Bits = unsigned_type(Value) ^ (unsigned_type(1) << (sizeof(T) * 8 - 1));
+            return uint8_t(Bits >> (Byte * 8));
+        }
+    };
+
+    template<typename T>
+        requires std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559
+    struct radix_key<T>
+    {
+        using unsigned_type = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+        static constexpr size_t Bytes = sizeof(T);
+
+        static uint8_t Digit(T Value, size_t Byte)
+        {
+            // -0.0 and +0.0 are equal for `<`, so they keep input order like in std::stable_sort
+            // NaNs have no `<` order: they go by sign bit, negative ones first and positive ones last
+            if (Value == T(0))
+            {
+                Value = T(0);
+            }
+
+            // Negative values are flipped entirely (bigger magnitude goes first), positive ones get sign bit
+            constexpr unsigned_type SignBit = unsigned_type(1) << (sizeof(T) * 8 - 1);
+            const unsigned_type Bits = std::bit_cast<unsigned_type>(Value);
+            const unsigned_type Ordered = (Bits & SignBit) ? ~Bits : Bits | SignBit;
+            return uint8_t(Ordered >> (Byte * 8));
+        }
+    };
+
+    template<size_t N>
+    struct radix_key<std::array<char, N>>
+    {
+        static constexpr size_t Bytes = N;
+
+        static uint8_t Digit(const std::array<char, N>& Value, size_t Byte)
+        {
+            return uint8_t(Value[N - 1 - Byte]);
+        }
+    };
+
+    template<typename Tuple, size_t Index>
+    using tuple_elem_t = std::remove_cvref_t<decltype(std::declval<Tuple&>().template GetRef<Index>())>;
+
+    using radix_histogram = std::array<size_t, 256>;
+
+    // One radix pass: sorts by byte `Byte` of key `KeyIndex`
+    template<size_t KeyIndex, typename Tuple>
+    uint8_t radix_digit(Tuple& Record, size_t Byte)
+    {
+        return radix_key<tuple_elem_t<Tuple, KeyIndex>>::Digit(Record.template GetRef<KeyIndex>(), Byte);
+    }
+
+    // Returns false if pass doesn't reorder anything (all records have the same digit)
+    inline bool radix_offsets(const radix_histogram& Histogram, size_t Count, radix_histogram& Offsets)
+    {
+        size_t Offset = 0;
+        for (size_t Digit = 0; Digit < 256; ++Digit)
+        {
+            if (Histogram[Digit] == Count)
+            {
+                return false;
+            }
+            Offsets[Digit] = Offset;
+            Offset += Histogram[Digit];
+        }
+        return true;
+    }
+
+    // Sequential pass with precounted histogram
+    template<size_t KeyIndex, typename Tuple>
+    void radix_pass(std::vector<Tuple>& From, std::vector<Tuple>& To, size_t Byte, const radix_histogram& Histogram)
+    {
+        radix_histogram Offsets;
+        if (!radix_offsets(Histogram, From.size(), Offsets))
+        {
+            return;
+        }
+
+        for (Tuple& Record : From)
+        {
+            To[Offsets[radix_digit<KeyIndex>(Record, Byte)]++] = std::move(Record);
+        }
+        std::swap(From, To);
+    }
+
+    // Parallel pass: each part counts own histogram, then scatters into own ranges of each bucket
+    template<size_t KeyIndex, typename Tuple>
+    void radix_pass(std::vector<Tuple>& From, std::vector<Tuple>& To, size_t Byte, work_stealing_pool& Pool)
+    {
+        const size_t Parts = std::min(Pool.size(), std::max<size_t>(From.size() / 4096, 1));
+        const size_t PartSize = (From.size() + Parts - 1) / Parts;
+
+        std::vector<radix_histogram> Histograms(Parts, radix_histogram {});
+        {
+            task_group Group(Pool);
+            for (size_t Part = 0; Part < Parts; ++Part)
+            {
+                Group.Run([&, Part]
+                {
+                    const size_t End = std::min(From.size(), (Part + 1) * PartSize);
+                    for (size_t i = Part * PartSize; i < End; ++i)
+                    {
+                        ++Histograms[Part][radix_digit<KeyIndex>(From[i], Byte)];
+                    }
+                });
+            }
+            Group.Wait();
+        }
+
+        // Offsets: bucket by bucket, part by part (keeps sort stable)
+        size_t Offset = 0;
+        for (size_t Digit = 0; Digit < 256; ++Digit)
+        {
+            size_t Total = 0;
+            for (size_t Part = 0; Part < Parts; ++Part)
+            {
+                Total += Histograms[Part][Digit];
+            }
+            if (Total == From.size())
+            {
+                return;
+            }
+            for (size_t Part = 0; Part < Parts; ++Part)
+            {
+                const size_t PartCount = Histograms[Part][Digit];
+                Histograms[Part][Digit] = Offset;
+                Offset += PartCount;
+            }
+        }
+
+        {
+            task_group Group(Pool);
+            for (size_t Part = 0; Part < Parts; ++Part)
+            {
+                Group.Run([&, Part]
+                {
+                    radix_histogram& Offsets = Histograms[Part];
+                    const size_t End = std::min(From.size(), (Part + 1) * PartSize);
+                    for (size_t i = Part * PartSize; i < End; ++i)
+                    {
+                        To[Offsets[radix_digit<KeyIndex>(From[i], Byte)]++] = std::move(From[i]);
+                    }
+                });
+            }
+            Group.Wait();
+        }
+        std::swap(From, To);
+    }
+
+    template<size_t Index, size_t... KeyIndices>
+    constexpr size_t key_at = std::array<size_t, sizeof...(KeyIndices)> { KeyIndices... }[Index];
+
+    // Calls `Func(std::integral_constant<size_t, KeyIndex>, Byte)` for each radix pass in LSD order:
+    //   the least significant key goes first, each key from its lowest byte
+    template<typename Tuple, size_t... KeyIndices, typename F>
+    void for_each_radix_pass(sort_by<KeyIndices...>, F&& Func)
+    {
+        constexpr size_t KeyCount = sizeof...(KeyIndices);
+        [&]<size_t... Order>(std::index_sequence<Order...>)
+        {
+            ([&]
+            {
+                constexpr size_t KeyIndex = key_at<KeyCount - 1 - Order, KeyIndices...>;
+                for (size_t Byte = 0; Byte < radix_key<tuple_elem_t<Tuple, KeyIndex>>::Bytes; ++Byte)
+                {
+                    Func(std::integral_constant<size_t, KeyIndex>{}, Byte);
+                }
+            }(), ...);
+        }(std::make_index_sequence<KeyCount>{});
+    }
+
+    template<typename Tuple, size_t... KeyIndices>
+    constexpr size_t radix_pass_count = (radix_key<tuple_elem_t<Tuple, KeyIndices>>::Bytes + ...);
+
+    template<size_t... KeyIndices, typename Tuple>
+    void tuple_sort_impl(sort_by<KeyIndices...> Keys, std::vector<Tuple>& Records)
+    {
+        if (Records.size() < 2)
+        {
+            return;
+        }
+
+        // Histograms don't depend on order of records, so all of them are counted in one sweep
+        std::vector<radix_histogram> Histograms(radix_pass_count<Tuple, KeyIndices...>, radix_histogram {});
+        for (Tuple& Record : Records)
+        {
+            size_t Pass = 0;
+            for_each_radix_pass<Tuple>(Keys, [&](auto Key, size_t Byte)
+            {
+                ++Histograms[Pass++][radix_digit<Key()>(Record, Byte)];
+            });
+        }
+
+        // Vectors are swapped after each pass, so `Records` always holds the last result
+        std::vector<Tuple> Buffer(Records);
+        size_t Pass = 0;
+        for_each_radix_pass<Tuple>(Keys, [&](auto Key, size_t Byte)
+        {
+            radix_pass<Key()>(Records, Buffer, Byte, Histograms[Pass++]);
+        });
+    }
+
+    template<size_t... KeyIndices, typename Tuple>
+    void tuple_sort_impl(sort_by<KeyIndices...> Keys, std::vector<Tuple>& Records, work_stealing_pool& Pool)
+    {
+        if (Records.size() < 2)
+        {
+            return;
+        }
+
+        std::vector<Tuple> Buffer(Records);
+        for_each_radix_pass<Tuple>(Keys, [&](auto Key, size_t Byte)
+        {
+            radix_pass<Key()>(Records, Buffer, Byte, Pool);
+        });
+    }
+}
+// Stable radix sort of tuples by keys
+// Usage: tuple_sort<sort_by<2, 0>>(Records)
+template<typename SortBy, typename Tuple>
+void tuple_sort(std::vector<Tuple>& Records)
+{
+    detail::tuple_sort_impl(SortBy{}, Records);
+}
+
+// Parallel version (passes are split between pool workers)
+template<typename SortBy, typename Tuple>
+void tuple_sort(std::vector<Tuple>& Records, work_stealing_pool& Pool)
+{
+    detail::tuple_sort_impl(SortBy{}, Records, Pool);
+}
+
+#ifdef TUPLE_SORT_DEMO
+    #undef TUPLE_SORT_DEMO
+
+// Count records by (float, uint): tuple_sort (one thread and on Pool) vs comparison sorts, milliseconds per sort
+// Small inputs are sorted several times, so each result covers at least 1M sorted records
+void Benchmark(size_t Count, work_stealing_pool& Pool)
+{
+    using record = htuple<uint32_t, int64_t, float>;
+
+    std::vector<record> Records;
+    Records.reserve(Count);
+    uint64_t Seed = 1;
+    for (size_t i = 0; i < Count; ++i)
+    {
+        Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+        Records.push_back(record(uint32_t(Seed >> 40), int64_t(i), float(int32_t(Seed >> 32) % 100000) / 8));
+    }
+
+    auto Less = [](const record& A, const record& B)
+    {
+        return A.GetRef<2>() < B.GetRef<2>() || (A.GetRef<2>() == B.GetRef<2>() && A.GetRef<0>() < B.GetRef<0>());
+    };
+
+    using clock = std::chrono::steady_clock;
+    const size_t Rounds = std::max<size_t>(1000000 / Count, 1);
+
+    // Sorts fresh copy of Records Rounds times, Out keeps the last result
+    auto Time = [&](std::vector<record>& Out, auto&& Sort)
+    {
+        double Total = 0;
+        for (size_t Round = 0; Round < Rounds; ++Round)
+        {
+            Out = Records;
+            const clock::time_point Start = clock::now();
+            Sort(Out);
+            Total += std::chrono::duration<double, std::milli>(clock::now() - Start).count();
+        }
+        return Total / double(Rounds);
+    };
+
+    std::vector<record> Stable;
+    const double StableTime = Time(Stable, [&](std::vector<record>& Out) { std::stable_sort(Out.begin(), Out.end(), Less); });
+
+    // Compares with std::stable_sort result by record number
+    auto SameAsStable = [&](const std::vector<record>& Sorted)
+    {
+        for (size_t i = 0; i < Sorted.size(); ++i)
+        {
+            if (Sorted[i].GetRef<1>() != Stable[i].GetRef<1>())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<record> Sorted;
+    const double RadixTime = Time(Sorted, [](std::vector<record>& Out) { tuple_sort<sort_by<2, 0>>(Out); });
+    bool bSame = SameAsStable(Sorted);
+
+    const double ParallelTime = Time(Sorted, [&](std::vector<record>& Out) { tuple_sort<sort_by<2, 0>>(Out, Pool); });
+    bSame = bSame && SameAsStable(Sorted);
+
+    const double UnstableTime = Time(Sorted, [&](std::vector<record>& Out) { std::sort(Out.begin(), Out.end(), Less); });
+
+    std::cout << Count << " records, tuple_sort: " << RadixTime << " ms, parallel (" << Pool.size() << " threads): " << ParallelTime
+        << " ms, std::stable_sort: " << StableTime << " ms, std::sort: " << UnstableTime << " ms, same as std::stable_sort: " << bSame << std::endl; // ... 1
+}
+
+int main()
+{
+    std::vector<htuple<uint32_t, int64_t, float>> Records {
+        { 3, -5, 1.5f },
+        { 1, 7, -2.0f },
+        { 2, -5, 1.5f },
+        { 0, 7, -0.5f },
+        { 4, 0, -2.0f },
+    };
+
+    tuple_sort<sort_by<2, 0>>(Records);
+
+    std::cout << "By float, then uint:";
+    for (auto& Record : Records)
+    {
+        std::cout << " (" << Record.Get<2>() << " " << Record.Get<0>() << ")";
+    }
+    std::cout << std::endl; // (-2 1) (-2 4) (-0.5 0) (1.5 2) (1.5 3)
+
+    std::vector<minituple<std::array<char, 4>, int>> Names {
+        { { 'b', 'o', 'b', 0 }, 1 },
+        { { 'a', 'n', 'n', 0 }, 2 },
+        { { 'a', 'l', 0, 0 }, 3 },
+    };
+
+    work_stealing_pool Pool(2);
+    tuple_sort<sort_by<0>>(Names, Pool);
+
+    std::cout << "By name:";
+    for (auto& Name : Names)
+    {
+        std::cout << " " << Name.Get<0>().data();
+    }
+    std::cout << std::endl; // al ann bob
+
+    std::vector<htuple<float, int>> Zeros { { 0.0f, 0 }, { -0.0f, 1 }, { 0.0f, 2 }, { -1.0f, 3 } };
+    tuple_sort<sort_by<0>>(Zeros);
+
+    std::cout << "Zeros keep order:";
+    for (auto& Zero : Zeros)
+    {
+        std::cout << " " << Zero.Get<1>();
+    }
+    std::cout << std::endl; // 3 0 1 2
+
+    // 100M records take about 10 GB, so that size runs only with CPPFUN_DEMO_LARGE
+    work_stealing_pool BenchmarkPool;
+    for (size_t Count = 1000; Count <= 10000000; Count *= 10)
+    {
+        Benchmark(Count, BenchmarkPool);
+    }
+#ifdef CPPFUN_DEMO_LARGE
+    Benchmark(100000000, BenchmarkPool);
+#endif
+}
+#endif
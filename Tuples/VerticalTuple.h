@@ -1,6 +1,11 @@
 // github.com/broly/CppFun
 // This is minimal as possible vertical tuple implementation
+
+#pragma once
+
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 template<typename... Ts>
 struct vtuple;
@@ -19,6 +24,16 @@ namespace detail
 		{
 			return Data.Value;
 		}
+
+		static constexpr auto& GetRef(vtuple<T, Ts...>& Data)
+		{
+			return Data.Value;
+		}
+
+		static constexpr const auto& GetRef(const vtuple<T, Ts...>& Data)
+		{
+			return Data.Value;
+		}
 	};
 
 	// Accessing to any element (iter from 'Index' downto 0 and pass 'Rest' tuple for each iteration)
@@ -30,6 +45,16 @@ namespace detail
 		{
 			return GetHelper<Index - 1, vtuple<Ts...>>::Get((vtuple<Ts...>&)Data);
 		}
+
+		static constexpr auto& GetRef(vtuple<T, Ts...>& Data)
+		{
+			return GetHelper<Index - 1, vtuple<Ts...>>::GetRef((vtuple<Ts...>&)Data);
+		}
+
+		static constexpr const auto& GetRef(const vtuple<T, Ts...>& Data)
+		{
+			return GetHelper<Index - 1, vtuple<Ts...>>::GetRef((const vtuple<Ts...>&)Data);
+		}
 	};
 }
 
@@ -41,6 +66,24 @@ struct vtuple<T>
 	constexpr vtuple(const T& InValue)
 		: Value(InValue)
 	{}
+
+	// Allocator-extended constructors (allocator is passed to the element if it accepts one)
+	// The element is constructed in place from the argument (a tuple goes to copy/move below)
+	template<typename Alloc, typename U>
+		requires (!std::is_same_v<std::remove_cvref_t<U>, vtuple>)
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, U&& InValue)
+		: Value(std::make_obj_using_allocator<T>(Allocator, std::forward<U>(InValue)))
+	{}
+
+	template<typename Alloc>
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, const vtuple& Other)
+		: Value(std::make_obj_using_allocator<T>(Allocator, Other.Value))
+	{}
+
+	template<typename Alloc>
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, vtuple&& Other)
+		: Value(std::make_obj_using_allocator<T>(Allocator, std::move(Other.Value)))
+	{}
 	
 	T Value;
 
@@ -50,6 +93,19 @@ struct vtuple<T>
 		return Value;
 	}
 
+	// Access to the element itself (not a copy)
+	template<size_t Index>
+	auto& GetRef()
+	{
+		return Value;
+	}
+
+	template<size_t Index>
+	const auto& GetRef() const
+	{
+		return Value;
+	}
+
 	template<size_t Index>
 	auto GetLast()
 	{
@@ -64,8 +120,29 @@ template<typename T, typename... Ts>
 struct vtuple<T, Ts...> : vtuple<Ts...>
 {
 	constexpr vtuple(const T& InValue, const Ts&... InRest)
-		: Value(InValue)
-		, vtuple<Ts...>(InRest...)
+		: vtuple<Ts...>(InRest...)
+		, Value(InValue)
+	{}
+
+	// Allocator-extended constructors (allocator is passed to each element that accepts it)
+	// Elements are constructed in place from forwarded arguments
+	template<typename Alloc, typename U, typename... Us>
+		requires (sizeof...(Us) == sizeof...(Ts))
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, U&& InValue, Us&&... InRest)
+		: vtuple<Ts...>(std::allocator_arg, Allocator, std::forward<Us>(InRest)...)
+		, Value(std::make_obj_using_allocator<T>(Allocator, std::forward<U>(InValue)))
+	{}
+
+	template<typename Alloc>
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, const vtuple& Other)
+		: vtuple<Ts...>(std::allocator_arg, Allocator, static_cast<const vtuple<Ts...>&>(Other))
+		, Value(std::make_obj_using_allocator<T>(Allocator, Other.Value))
+	{}
+
+	template<typename Alloc>
+	constexpr vtuple(std::allocator_arg_t, const Alloc& Allocator, vtuple&& Other)
+		: vtuple<Ts...>(std::allocator_arg, Allocator, static_cast<vtuple<Ts...>&&>(Other))
+		, Value(std::make_obj_using_allocator<T>(Allocator, std::move(Other.Value)))
 	{}
 	
 	T Value;
@@ -76,6 +153,19 @@ struct vtuple<T, Ts...> : vtuple<Ts...>
 		return detail::GetHelper<Index, vtuple<T, Ts...>>::Get(*this);
 	}
 
+	// Access to the element itself (not a copy)
+	template<size_t Index>
+	auto& GetRef()
+	{
+		return detail::GetHelper<Index, vtuple<T, Ts...>>::GetRef(*this);
+	}
+
+	template<size_t Index>
+	const auto& GetRef() const
+	{
+		return detail::GetHelper<Index, vtuple<T, Ts...>>::GetRef(*this);
+	}
+
 	template<size_t Index = 0>
 	auto GetLast()
 	{
@@ -95,6 +185,12 @@ struct vtuple<>
 	static constexpr size_t size = 0;
 };
 
+// Containers pass their allocator to tuple (like to std::tuple)
+template<typename... Ts, typename Alloc>
+struct std::uses_allocator<vtuple<Ts...>, Alloc> : std::true_type {};
+
+// Demo (define CPPFUN_NO_DEMO to include this file)
+#ifndef CPPFUN_NO_DEMO
 int main()
 {
     vtuple<int, float, bool, const char*> tup {33, 2.3f, true, "qwerty"};
@@ -102,4 +198,5 @@ int main()
     std::cout << "Tuple: " << tup.Get<0>() << " " << tup.Get<1>() << " " << tup.Get<2>() << " " << tup.Get<3>() << std::endl;
     std::cout << "Last: " << tup.GetLast() << std::endl;
     std::cout << "Tuple size: " << tup.size;
-}
\ No newline at end of file
+}
+#endif